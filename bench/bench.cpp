@@ -0,0 +1,287 @@
+/**
+ * @file bench.cpp
+ * @brief Benchmark suite for loading, training and prediction
+ *
+ * Every case is timed over repeated samples and reported as JSON with the
+ * median and 99th percentile, plus the heap allocations it makes, so
+ * results can be diffed across upgrades:
+ *
+ *     bench [--quick] [--out bench.json] [--filter substring]
+ *
+ * Library chatter goes to stdout; the JSON goes to the --out file and
+ * progress lines to stderr. With `--out -` the JSON goes to stdout
+ * instead and the library chatter is discarded, so stdout parses as JSON.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "HomemadeScikit/dataset.h"
+#include "HomemadeScikit/model.h"
+#include "HomemadeScikit/simd.h"
+
+using namespace std;
+
+typedef struct bench_result
+{
+    string name;
+    size_t rows;
+    int features;
+    size_t ops;     // operations per sample
+    size_t samples;
+    double median;  // ns per operation
+    double p99;     // ns per operation
+    double allocs;  // heap allocations per operation
+} bench_result;
+
+static vector<bench_result> results;
+static string filter;
+
+// keeps the optimizer from discarding the work being timed
+static volatile double sink;
+
+// every operator new in the process, so a case can report its allocations
+static atomic<size_t> allocations(0);
+
+void *operator new(size_t n)
+{
+    allocations.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(n ? n : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+/**
+ * Time `fn` (which performs `ops` operations) until at least `budget`
+ * seconds have been spent or `maxSamples` samples taken, after one
+ * warm-up call.
+ */
+static void measure(const string &name, size_t rows, int features, size_t ops,
+                    const function<void()> &fn, double budget = 0.5, size_t maxSamples = 200)
+{
+    if (!filter.empty() && name.find(filter) == string::npos)
+        return;
+
+    using clock = chrono::steady_clock;
+    fn();
+
+    vector<double> samples;
+    samples.reserve(max<size_t>(maxSamples, 5));
+    size_t allocated = allocations.load();
+    auto start = clock::now();
+    while (samples.size() < 5 ||
+           (samples.size() < maxSamples && chrono::duration<double>(clock::now() - start).count() < budget))
+    {
+        auto t = clock::now();
+        fn();
+        samples.push_back(chrono::duration<double, nano>(clock::now() - t).count() / ops);
+    }
+
+    double allocs = double(allocations.load() - allocated) / (samples.size() * ops);
+    sort(samples.begin(), samples.end());
+    size_t s = samples.size();
+    double median = s % 2 ? samples[s / 2] : 0.5 * (samples[s / 2 - 1] + samples[s / 2]);
+    double p99 = samples[min(s - 1, size_t(0.99 * (s - 1) + 0.5))];
+    results.push_back({name, rows, features, ops, s, median, p99, allocs});
+
+    cerr << name << " rows=" << rows << ": median " << median << " ns, p99 " << p99 << " ns, " << allocs
+         << " allocations (" << s << " samples)" << endl;
+}
+
+// deterministic linear data with a few missing cells
+static string write_csv(size_t rows, int features)
+{
+    string path = (filesystem::temp_directory_path() / ("hs_bench_" + to_string(rows) + ".csv")).string();
+    ofstream out(path);
+    for (int j = 0; j < features; j++)
+        out << "x" << j << ",";
+    out << "y\n";
+
+    uint64_t state = 42;
+    for (size_t i = 0; i < rows; i++)
+    {
+        double y = 1;
+        for (int j = 0; j < features; j++)
+        {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            double v = double(state >> 11) / double(1ull << 53);
+            y += (j + 1) * v;
+            if ((i + j) % 997 == 0)
+                out << ",";
+            else
+                out << v << ",";
+        }
+        out << y << "\n";
+    }
+    return path;
+}
+
+static void bench_size(size_t rows, int features)
+{
+    string path = write_csv(rows, features);
+    vector<variant<string, int>> x;
+    for (int j = 0; j < features; j++)
+        x.push_back(j);
+
+    measure("load_csv", rows, features, 1, [&]
+            { dataset d(path); sink = d.rows(); });
+
+    dataset d(path);
+    d.chooseX(x).chooseY(features);
+
+    size_t n = d.rows();
+    measure("get_row", rows, features, n, [&]
+            {
+                double acc = 0;
+                for (size_t i = 0; i < n; i++)
+                    acc += d.getRow(i)[0];
+                sink = acc; });
+
+    model m(d);
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 20;
+    settings.step = 0.1;
+    measure("train_epoch", rows, features, settings.epochs, [&]
+            { m.train(settings); }, 1.0, 50);
+
+    measure("calc_j", rows, features, 1, [&]
+            { m.calcJ(); sink = m.getJ(); });
+
+    vector<double> row(features, 0.5);
+    measure("predict_row", rows, features, 1000, [&]
+            {
+                double acc = 0;
+                for (int i = 0; i < 1000; i++)
+                    acc += m.predict(row);
+                sink = acc; });
+
+    vector<double> out(n);
+    measure("predict_dataset", rows, features, n, [&]
+            { m.predict(d, out.data(), out.size()); sink = out[0]; });
+
+    string text = (filesystem::temp_directory_path() / "hs_bench_model.anouar").string();
+    string bin = (filesystem::temp_directory_path() / "hs_bench_model").string();
+    // each import case writes its own file, so it also runs on its own (--filter)
+    measure("export_text", rows, features, 1, [&]
+            { m.export_to_file(text); });
+    m.export_to_file(text);
+    measure("import_text", rows, features, 1, [&]
+            { model loaded; loaded.import(text); });
+    measure("export_binary", rows, features, 1, [&]
+            { m.export_binary(bin); });
+    m.export_binary(bin);
+    measure("import_binary", rows, features, 1, [&]
+            { model loaded; loaded.import(bin + ".hsm"); });
+
+    filesystem::remove(path);
+    filesystem::remove(text);
+    filesystem::remove(bin + ".hsm");
+}
+
+static string json_escape(const string &s)
+{
+    string out;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void write_json(ostream &out)
+{
+    out << "{\n  \"version\": 2,\n";
+    out << "  \"simd\": \"" << simd_name(simd().isa) << "\",\n";
+    out << "  \"hardware_threads\": " << thread::hardware_concurrency() << ",\n";
+    out << "  \"unit\": \"ns/op\",\n";
+    out << "  \"cases\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const bench_result &r = results[i];
+        out << (i ? "," : "") << "\n    {\"name\": \"" << json_escape(r.name) << "\", \"rows\": " << r.rows
+            << ", \"features\": " << r.features << ", \"ops\": " << r.ops << ", \"samples\": " << r.samples
+            << ", \"median\": " << r.median << ", \"p99\": " << r.p99 << ", \"allocs\": " << r.allocs << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char **argv)
+{
+    bool quick = false;
+    string outPath = "bench.json";
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--quick")
+            quick = true;
+        else if (arg == "--out" && i + 1 < argc)
+            outPath = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else
+        {
+            cerr << "usage: bench [--quick] [--out file|-] [--filter substring]" << endl;
+            return 1;
+        }
+    }
+
+    // while the JSON owns stdout, whatever the library prints (through
+    // printf or cout) goes to /dev/null instead
+    int console = -1;
+    if (outPath == "-")
+    {
+        fflush(stdout);
+        console = dup(STDOUT_FILENO);
+        int discard = open("/dev/null", O_WRONLY);
+        if (console < 0 || discard < 0)
+        {
+            cerr << "Cannot redirect stdout" << endl;
+            return 1;
+        }
+        dup2(discard, STDOUT_FILENO);
+        close(discard);
+    }
+
+    const int features = 8;
+    vector<size_t> sizes = quick ? vector<size_t>{1000, 10000} : vector<size_t>{10000, 100000, 1000000};
+    for (size_t rows : sizes)
+        bench_size(rows, features);
+
+    if (outPath == "-")
+    {
+        cout.flush();
+        fflush(stdout);
+        dup2(console, STDOUT_FILENO);
+        close(console);
+        write_json(cout);
+        return 0;
+    }
+    ofstream out(outPath);
+    if (!out.is_open())
+    {
+        cerr << "Cannot open file: " << outPath << endl;
+        return 1;
+    }
+    write_json(out);
+    cerr << "wrote " << outPath << endl;
+    return 0;
+}
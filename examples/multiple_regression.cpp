@@ -27,8 +27,15 @@ int main()
 
         cout << "Initial cost: " << m.getJ() << endl;
 
-        // Train the model
-        m.train({.algo = "gradient", .epochs = 1000, .step = 0.001});
+        // Train the model, printing progress every 100 epochs
+        log_sink progress(cout);
+        model_settings settings;
+        settings.algo = "gradient";
+        settings.epochs = 1000;
+        settings.step = 0.001;
+        settings.observer = &progress;
+        settings.interval = 100;
+        m.train(settings);
 
         // Make predictions
         vector<double> testInput = {1.0, 2.0, 4, 5};
@@ -3,22 +3,518 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <new>
+#include <utility>
 
 using namespace std;
 
+/**
+ * @brief Allocator whose value-construction leaves the element unwritten
+ *
+ * `vector<T, default_init_allocator<T>>::resize(n)` then only reserves
+ * the cells, so a buffer that a loader is about to overwrite is not
+ * zero-filled first (nor its pages touched before they are written).
+ */
+template <class T>
+struct default_init_allocator : allocator<T>
+{
+    template <class U>
+    struct rebind
+    {
+        typedef default_init_allocator<U> other;
+    };
+
+    default_init_allocator() = default;
+    template <class U>
+    default_init_allocator(const default_init_allocator<U> &) noexcept {}
+
+    template <class U>
+    void construct(U *p) noexcept { ::new (static_cast<void *>(p)) U; }
+    template <class U, class... A>
+    void construct(U *p, A &&...args) { ::new (static_cast<void *>(p)) U(std::forward<A>(args)...); }
+};
+
+/**
+ * @brief Summary of a column's set cells
+ *
+ * min, max, mean and (population) variance are NaN when no cell is set.
+ */
+typedef struct column_stats
+{
+    size_t count = 0; // set cells
+    size_t nulls = 0; // missing cells
+    double min = NAN;
+    double max = NAN;
+    double mean = NAN;
+    double variance = NAN;
+} column_stats;
+
+/**
+ * @brief Summarize `n` values in one pass
+ * @param bits Validity bitmap, or nullptr when every value is set
+ *
+ * Works a cache-sized block at a time: each block's mean and squared
+ * deviations are taken while the block is hot, then blocks are combined
+ * with Chan's pairwise update, which keeps the variance accurate for
+ * large offsets.
+ */
+column_stats summarize(const double *v, const uint64_t *bits, size_t n);
+column_stats summarize(const float *v, const uint64_t *bits, size_t n);
+
+/** @brief Combine the summaries of two disjoint sets of cells */
+column_stats merge(const column_stats &a, const column_stats &b);
+
+/** @brief Code of a missing cell in a category column */
+const uint32_t NO_LEVEL = 0xffffffff;
+
 /**
  * @brief Represents a single column in the dataset.
  *
- * Each column stores the header name, a vector of (value, is_set) pairs
- * for numeric values (missing values are represented with is_set == false),
- * and a string `type` describing the data type (currently "double").
+ * Values live in one contiguous buffer so that scans can stream
+ * them; missing cells hold 0.0 in that buffer and are tracked by a packed
+ * validity bitmap (bit set == value present) with a cached null count.
+ * `type` is "double" or "float": a float column keeps its values in a
+ * `float` buffer instead (half the memory and bandwidth), read through
+ * floatData(); value() works for both.
+ *
+ * `type` "category" stores dictionary codes instead: one uint32_t per
+ * cell (NO_LEVEL where missing) indexing `levels()`, a dictionary shared
+ * by every copy of the column. `kind` is what the cells mean ("double",
+ * "int", "bool" or "category", as inferred by the loader); int and bool
+ * cells are stored like double ones.
+ *
+ * The buffers are either owned or borrowed from read-only memory kept
+ * alive by `backing` (e.g. a memory-mapped binary dataset). A borrowed
+ * column copies its buffers into owned storage on the first mutation.
+ *
+ * stats() is computed on first use and cached until the column changes
+ * (any mutator, including handing out mutableData(), drops the cache).
+ * Like the rest of the class, it is not safe to call concurrently with
+ * itself on the same column.
  */
 class column
 {
+private:
+    vector<double, default_init_allocator<double>> values;
+    vector<float> floats;      // the storage instead of `values` when `single`
+    vector<uint32_t, default_init_allocator<uint32_t>> codes; // the storage when `categorical`
+    shared_ptr<const vector<string>> dictionary;
+    vector<uint64_t> validity; // one bit per row, 1 == set
+    size_t nulls = 0;
+    bool single = false;
+    bool categorical = false;
+
+    const double *valuesPtr = nullptr;
+    const float *floatsPtr = nullptr;
+    const uint32_t *codesPtr = nullptr;
+    const uint64_t *validityPtr = nullptr;
+    size_t count = 0;
+    shared_ptr<const void> backing;
+
+    mutable column_stats summary;
+    mutable bool summarized = false;
+
+    /** Point the read accessors at the owned vectors */
+    void sync()
+    {
+        valuesPtr = single || categorical ? nullptr : values.data();
+        floatsPtr = single ? floats.data() : nullptr;
+        codesPtr = categorical ? codes.data() : nullptr;
+        validityPtr = validity.data();
+        count = single ? floats.size() : categorical ? codes.size() : values.size();
+    }
+
+    /** Take a private copy of borrowed buffers before mutating them */
+    void own()
+    {
+        if (!backing)
+            return;
+        if (single)
+            floats.assign(floatsPtr, floatsPtr + count);
+        else if (categorical)
+            codes.assign(codesPtr, codesPtr + count);
+        else
+            values.assign(valuesPtr, valuesPtr + count);
+        validity.assign(validityPtr, validityPtr + ((count + 63) >> 6));
+        backing.reset();
+        sync();
+    }
+
 public:
     string header;
-    vector<pair<double, bool>> data; // (value, hasbeenset) pairs
-    string type;                     // for now only double
+    string type;           // storage: "double", "float" or "category"
+    string kind = "double"; // meaning: "double", "int", "bool" or "category"
+
+    column() = default;
+    column(const column &o)
+        : values(o.values), floats(o.floats), codes(o.codes), dictionary(o.dictionary), validity(o.validity),
+          nulls(o.nulls), single(o.single), categorical(o.categorical), valuesPtr(o.valuesPtr),
+          floatsPtr(o.floatsPtr), codesPtr(o.codesPtr), validityPtr(o.validityPtr), count(o.count),
+          backing(o.backing), summary(o.summary), summarized(o.summarized), header(o.header), type(o.type),
+          kind(o.kind)
+    {
+        if (!backing)
+            sync();
+    }
+    column(column &&) = default;
+    column &operator=(column o)
+    {
+        swap(values, o.values);
+        swap(floats, o.floats);
+        swap(codes, o.codes);
+        dictionary = move(o.dictionary);
+        swap(validity, o.validity);
+        nulls = o.nulls;
+        single = o.single;
+        categorical = o.categorical;
+        valuesPtr = o.valuesPtr;
+        floatsPtr = o.floatsPtr;
+        codesPtr = o.codesPtr;
+        validityPtr = o.validityPtr;
+        count = o.count;
+        backing = move(o.backing);
+        summary = o.summary;
+        summarized = o.summarized;
+        header = move(o.header);
+        type = move(o.type);
+        kind = move(o.kind);
+        return *this;
+    }
+
+    /** @brief Number of cells (set or missing) */
+    size_t size() const { return count; }
+
+    /** @brief Number of missing cells */
+    size_t nullCount() const { return nulls; }
+
+    /** @brief Whether the cell at row `i` holds a value */
+    bool isSet(size_t i) const { return (validityPtr[i >> 6] >> (i & 63)) & 1; }
+
+    /** @brief Value at row `i` (0.0 when missing); a category column gives the code (-1.0 when missing) */
+    double value(size_t i) const
+    {
+        if (categorical)
+            return codesPtr[i] == NO_LEVEL ? -1.0 : double(codesPtr[i]);
+        return single ? floatsPtr[i] : valuesPtr[i];
+    }
+
+    /** @brief Whether values are stored as float */
+    bool isFloat() const { return single; }
+
+    /** @brief Whether cells are stored as dictionary codes */
+    bool isCategory() const { return categorical; }
+
+    /** @brief Raw pointer to the codes (nullptr unless a category column) */
+    const uint32_t *codeData() const { return codesPtr; }
+
+    /** @brief The level names the codes index (null unless a category column) */
+    const shared_ptr<const vector<string>> &levels() const { return dictionary; }
+
+    /** @brief Raw pointer to the contiguous double buffer (nullptr for a float or category column) */
+    const double *data() const { return valuesPtr; }
+
+    /** @brief Raw pointer to the contiguous float buffer (nullptr for a double column) */
+    const float *floatData() const { return floatsPtr; }
+
+    /** @brief Count, nulls, min, max, mean and variance of the set cells (cached; count and nulls only for categories) */
+    const column_stats &stats() const
+    {
+        if (!summarized)
+        {
+            if (categorical)
+            {
+                summary = column_stats();
+                summary.count = count - nulls;
+                summary.nulls = nulls;
+            }
+            else
+                summary = single ? summarize(floatsPtr, validityPtr, count) : summarize(valuesPtr, validityPtr, count);
+            summarized = true;
+        }
+        return summary;
+    }
+
+    /** @brief Writable pointer to the double buffer (copies a borrowed column and widens a float one first; not for categories) */
+    double *mutableData()
+    {
+        widen();
+        own();
+        summarized = false;
+        return values.data();
+    }
+
+    /** @brief Writable pointer to the float buffer (copies a borrowed column and narrows a double one first; not for categories) */
+    float *mutableFloatData()
+    {
+        narrow();
+        own();
+        summarized = false;
+        return floats.data();
+    }
+
+    /** @brief Writable pointer to the codes of a category column (copies a borrowed one first) */
+    uint32_t *mutableCodes()
+    {
+        own();
+        summarized = false;
+        return codes.data();
+    }
+
+    /** @brief Replace the dictionary the codes index */
+    void setLevels(shared_ptr<const vector<string>> names) { dictionary = move(names); }
+
+    /** @brief Pointer range over the double buffer, usable in range-for (empty for a float column) */
+    const double *begin() const { return valuesPtr; }
+    const double *end() const { return valuesPtr ? valuesPtr + count : nullptr; }
+
+    /** @brief Raw pointer to the packed validity bitmap ((size() + 63) / 64 words) */
+    const uint64_t *validityBits() const { return validityPtr; }
+
+    /** @brief Whether the buffers are borrowed from external memory */
+    bool isBorrowed() const { return static_cast<bool>(backing); }
+
+    /**
+     * @brief Use external buffers without copying them
+     * @param v `n` values (0.0 where missing)
+     * @param bits (n + 63) / 64 validity words
+     * @param n Number of cells
+     * @param missing Number of cleared validity bits
+     * @param owner Keeps `v` and `bits` alive for as long as they are used
+     */
+    void borrow(const double *v, const uint64_t *bits, size_t n, size_t missing, shared_ptr<const void> owner)
+    {
+        values.clear();
+        floats.clear();
+        codes.clear();
+        validity.clear();
+        summarized = false;
+        single = false;
+        categorical = false;
+        type = "double";
+        backing = move(owner);
+        valuesPtr = v;
+        floatsPtr = nullptr;
+        codesPtr = nullptr;
+        validityPtr = bits;
+        count = n;
+        nulls = missing;
+    }
+
+    /** @brief Use an external float buffer without copying it (see above) */
+    void borrow(const float *v, const uint64_t *bits, size_t n, size_t missing, shared_ptr<const void> owner)
+    {
+        values.clear();
+        floats.clear();
+        codes.clear();
+        validity.clear();
+        summarized = false;
+        single = true;
+        categorical = false;
+        type = "float";
+        backing = move(owner);
+        valuesPtr = nullptr;
+        floatsPtr = v;
+        codesPtr = nullptr;
+        validityPtr = bits;
+        count = n;
+        nulls = missing;
+    }
+
+    /** @brief Use external codes without copying them (see above); `names` is their dictionary */
+    void borrow(const uint32_t *v, const uint64_t *bits, size_t n, size_t missing,
+                shared_ptr<const vector<string>> names, shared_ptr<const void> owner)
+    {
+        values.clear();
+        floats.clear();
+        codes.clear();
+        validity.clear();
+        summarized = false;
+        single = false;
+        categorical = true;
+        type = "category";
+        kind = "category";
+        dictionary = move(names);
+        backing = move(owner);
+        valuesPtr = nullptr;
+        floatsPtr = nullptr;
+        codesPtr = v;
+        validityPtr = bits;
+        count = n;
+        nulls = missing;
+    }
+
+    /**
+     * @brief Store the values as float (rounding each one), freeing the doubles
+     *
+     * Validity and nulls are unchanged; a no-op on a float or category column.
+     */
+    void narrow()
+    {
+        if (single || categorical)
+            return;
+        floats.assign(valuesPtr, valuesPtr + count);
+        if (backing)
+            validity.assign(validityPtr, validityPtr + ((count + 63) >> 6));
+        decltype(values)().swap(values);
+        backing.reset();
+        single = true;
+        type = "float";
+        summarized = false;
+        sync();
+    }
+
+    /** @brief Store the values as double again; a no-op on a double column */
+    void widen()
+    {
+        if (!single)
+            return;
+        values.assign(floatsPtr, floatsPtr + count);
+        if (backing)
+            validity.assign(validityPtr, validityPtr + ((count + 63) >> 6));
+        vector<float>().swap(floats);
+        backing.reset();
+        single = false;
+        type = "double";
+        summarized = false;
+        sync();
+    }
+
+    /** @brief Reserve room for `n` cells */
+    void reserve(size_t n)
+    {
+        own();
+        if (single)
+            floats.reserve(n);
+        else if (categorical)
+            codes.reserve(n);
+        else
+            values.reserve(n);
+        validity.reserve((n + 63) >> 6);
+        sync();
+    }
+
+    /** @brief Append a cell; `set == false` marks it as missing (not for categories) */
+    void push_back(double v, bool set)
+    {
+        own();
+        summarized = false;
+        size_t i = count;
+        if ((i & 63) == 0)
+            validity.push_back(0);
+        if (set)
+            validity.back() |= uint64_t(1) << (i & 63);
+        else
+        {
+            v = 0.0;
+            nulls++;
+        }
+        if (single)
+            floats.push_back(float(v));
+        else
+            values.push_back(v);
+        sync();
+    }
+
+    /**
+     * @brief Resize to `n` double cells, all marked set and left unwritten
+     *
+     * Used by loaders that write every value through mutableData() and
+     * then flag the missing ones with setMissing(), which zeroes them;
+     * the buffer is not filled beforehand.
+     */
+    void assign(size_t n)
+    {
+        backing.reset();
+        summarized = false;
+        single = false;
+        categorical = false;
+        type = "double";
+        kind = "double";
+        vector<float>().swap(floats);
+        decltype(codes)().swap(codes);
+        dictionary.reset();
+        values.clear();
+        values.resize(n);
+        validity.assign((n + 63) >> 6, ~uint64_t(0));
+        if (n & 63)
+            validity.back() = (uint64_t(1) << (n & 63)) - 1;
+        nulls = 0;
+        sync();
+    }
+
+    /** @brief Like assign(), for a category column written through mutableCodes() */
+    void assignCodes(size_t n)
+    {
+        assign(0);
+        decltype(values)().swap(values);
+        categorical = true;
+        type = "category";
+        kind = "category";
+        codes.resize(n);
+        validity.assign((n + 63) >> 6, ~uint64_t(0));
+        if (n & 63)
+            validity.back() = (uint64_t(1) << (n & 63)) - 1;
+        sync();
+    }
+
+    /**
+     * @brief Grow or trim an assign()ed column to `n` cells, keeping the
+     * first ones; added cells are set and unwritten, like assign()'s
+     *
+     * For a loader that sized the column from an estimate. Cells trimmed
+     * off must not have been flagged missing.
+     */
+    void resize(size_t n)
+    {
+        own();
+        summarized = false;
+        if (count & 63)
+            validity.back() |= ~((uint64_t(1) << (count & 63)) - 1);
+        if (categorical)
+            codes.resize(n);
+        else
+            values.resize(n);
+        validity.resize((n + 63) >> 6, ~uint64_t(0));
+        if (n & 63)
+            validity.back() &= (uint64_t(1) << (n & 63)) - 1;
+        sync();
+    }
+
+    /** @brief Mark row `i` as missing (its value becomes 0.0, its code NO_LEVEL) */
+    void setMissing(size_t i)
+    {
+        own();
+        summarized = false;
+        uint64_t bit = uint64_t(1) << (i & 63);
+        if (validity[i >> 6] & bit)
+        {
+            validity[i >> 6] &= ~bit;
+            if (single)
+                floats[i] = 0.0f;
+            else if (categorical)
+                codes[i] = NO_LEVEL;
+            else
+                values[i] = 0.0;
+            nulls++;
+        }
+    }
+
+    /** @brief Remove every cell */
+    void clear()
+    {
+        backing.reset();
+        summarized = false;
+        values.clear();
+        floats.clear();
+        codes.clear();
+        validity.clear();
+        nulls = 0;
+        sync();
+    }
 };
 
 #endif // HOMEMADESCIKIT_COLUMN_H
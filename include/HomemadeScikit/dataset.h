@@ -4,16 +4,44 @@
 #include <vector>
 #include <variant>
 #include <string>
+#include <string_view>
 #include "column.h"
 #include "data_settings.h"
 
 using namespace std;
 
+/**
+ * @brief Options for loading a dataset from disk
+ *
+ * - `threads` is the number of workers parsing the CSV (0 = all cores);
+ *   the file is split into newline-aligned chunks, one task per chunk
+ * - `cache` keeps a binary copy beside the CSV (`<file>.hsd`): it is built
+ *   on first load and used instead of the CSV while it is not older
+ * - `precision` is "double" or "float"; float columns take half the
+ *   memory, and models trained on them run the single-precision kernels
+ * - `infer` types every column from its first `sample` data lines: a
+ *   column whose non-empty cells are mostly not numbers becomes a
+ *   "category" column (each distinct text one level of its dictionary,
+ *   cells stored as 4-byte codes); otherwise its kind is "bool" when every
+ *   value is 0, 1, true or false, "int" when every value is integral, and
+ *   "double" else. Cells that do not parse as the column's kind are
+ *   missing. Without it every column is "double"
+ */
+typedef struct load_settings
+{
+    int threads = 1;
+    bool cache = false;
+    string precision = "double";
+    bool infer = false;
+    size_t sample = 1000;
+} load_settings;
+
 /**
  * @brief A very small CSV dataset container.
  *
  * The dataset stores data in a column-oriented fashion using `column`.
- * It supports loading numerical CSV files (missing entries are allowed),
+ * It supports loading numerical CSV files (missing entries are allowed,
+ * text columns become categories when load_settings.infer is set),
  * selecting features and target columns, and printing or retrieving rows.
  */
 class dataset
@@ -21,20 +49,34 @@ class dataset
 private:
     bool loaded;
 
+    // one chunk's missing cells and category levels (see dataset.cpp)
+    struct chunk_arena;
+
     /**
      * @brief Parse a header line and initialize columns
      * @param line The CSV header line
      * @return number of headers/columns found
      */
-    int loadHeaders(string);
+    int loadHeaders(string_view);
 
     /**
-     * @brief Parse a CSV data line and append values to columns
-     * @param line The CSV data line
+     * @brief Parse a CSV data line in place into preallocated columns
+     * @param line The CSV data line (a view into the mapped file)
+     * @param row Row index to write
      * @param n Number of columns (used to validate/align fields)
+     * @param cells Each column's value buffer, taken before the parse
+     * @param codes Each category column's code buffer, likewise
+     * @param chunk Arena receiving the rows of missing cells and the levels
      * @return 0 on success, non-zero on parse error
+     *
+     * Malformed or empty cells are recorded as missing; nothing throws.
+     * Values are written straight into the column buffers, while missing
+     * cells are only collected (in the chunk's arena) so that several
+     * chunks can be parsed concurrently without sharing bitmap words.
+     * Category cells get codes from the chunk's own dictionary, which the
+     * load merges into the column's afterwards.
      */
-    int loadLine(string, int);
+    int loadLine(string_view, size_t, int, double *const *, uint32_t *const *, chunk_arena &);
 
 public:
     vector<column> data;
@@ -43,11 +85,52 @@ public:
     /** @brief Construct an empty dataset */
     dataset();
 
-    /** @brief Construct a dataset and load from file */
-    dataset(string);
+    /** @brief Construct a dataset and load from a .csv or .hsd file */
+    dataset(string, const load_settings & = {});
+
+    /**
+     * @brief Load a CSV file into this dataset
+     *
+     * The file is memory-mapped and tokenized in place; cells are parsed
+     * with from_chars directly into column buffers sized up front.
+     * With `threads != 1` the file is cut into newline-aligned chunks that
+     * are parsed in parallel, each straight into its own row range of the
+     * shared buffers; row order and missing-value handling are unchanged.
+     * A single-threaded load sizes the buffers from the file size and the
+     * line length of its first rows instead of counting the lines first.
+     * Apart from the column buffers and category dictionaries, the load
+     * allocates only from per-chunk arenas released when it returns.
+     */
+    void load_csv(string, const load_settings & = {});
+
+    /**
+     * @brief Load a binary dataset written by save_binary
+     *
+     * The file is memory-mapped and the columns borrow their buffers from
+     * the mapping, so nothing is parsed or copied.
+     */
+    void load_binary(string);
+
+    /**
+     * @brief Save the dataset as a versioned binary columnar file (.hsd)
+     *
+     * Layout: a fixed header, a column directory, a string table with the
+     * headers, types and category levels, then each column's values (or
+     * codes) and validity bitmap, every section aligned to 64 bytes. Values
+     * are stored in native (little-endian on supported platforms) byte
+     * order. Version 2 added the kinds and categories; version 1 files
+     * still load, as "double" columns.
+     */
+    void save_binary(string);
 
-    /** @brief Load a CSV file into this dataset */
-    void load_csv(string);
+    /**
+     * @brief Store every column as "float" or "double"
+     *
+     * Narrowing rounds each value to float and frees the double buffers;
+     * widening back does not restore the lost digits. Category columns keep
+     * their codes.
+     */
+    void setPrecision(string);
 
     /** @brief Whether the dataset has been successfully loaded */
     bool isLoaded() { return loaded; }
@@ -58,7 +141,7 @@ public:
     /** @brief Number of rows */
     int rows();
 
-    /** @brief Get a printable representation of the value at (row,col) */
+    /** @brief Get a printable representation of the value at (row,col) (the level of a category) */
     string getValue(int row, int col);
 
     /** @brief Print the dataset to stdout in CSV format */
@@ -74,6 +157,15 @@ public:
     dataset &chooseY(string);
     dataset &chooseY(int);
 
+    /**
+     * @brief Count, nulls, min, max, mean and variance of a column
+     *
+     * Computed in one pass on first use and cached in the column until it
+     * is modified. Throws out_of_range for an unknown column.
+     */
+    const column_stats &stats(int);
+    const column_stats &stats(string);
+
     /** @brief Return the feature values for a row as a vector */
     vector<double> getRow(int);
 };
@@ -0,0 +1,106 @@
+#ifndef HOMEMADESCIKIT_DATASET_VIEW_H
+#define HOMEMADESCIKIT_DATASET_VIEW_H
+
+#include <vector>
+#include <string>
+#include <variant>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include "dataset.h"
+#include "data_settings.h"
+#include "row_source.h"
+
+using namespace std;
+
+/**
+ * @brief A subset of a dataset's rows that shares its column buffers
+ *
+ * The rows are a list of half-open ranges (a k-fold training split is
+ * two) or an explicit index list, in the order they are visited. The view
+ * keeps its own `settings`, initially the parent's, so it can choose
+ * different columns without touching the parent. The parent must outlive
+ * the view and must not be reloaded while the view is in use.
+ *
+ * As a row_source, a view trains a model, computes its cost and is scored
+ * by model::predict(row_source&, ...) directly. Ranges over double
+ * columns are handed out as pointers into the parent, one batch per
+ * range, so they copy nothing. Index lists and float columns are gathered
+ * (widened) into a bounded buffer of `chunkRows` rows instead. Category
+ * columns cannot be streamed: next() throws when one is chosen.
+ */
+class dataset_view : public row_source
+{
+private:
+    dataset *parent;
+    vector<pair<size_t, size_t>> ranges;    // [begin, end) parent rows
+    shared_ptr<const vector<size_t>> index; // explicit parent rows, shared by copies
+    size_t total = 0;
+    size_t chunkRows;
+
+    // position of the pass: the next range (or index entry), and the
+    // next row inside that range
+    size_t piece = 0;
+    size_t offset = 0;
+
+    vector<int> chosen;              // parent columns: features in weight order, then the target
+    vector<vector<double>> gathered; // their rows, for index lists and float columns
+    size_t peak = 0;
+
+    void check(size_t rows);
+    bool zeroCopy();
+
+public:
+    data_settings settings;
+
+    /** @brief Every row of `parent` */
+    explicit dataset_view(dataset &parent, size_t chunkRows = 1 << 16);
+
+    /** @brief Parent rows [begin, end) */
+    dataset_view(dataset &parent, size_t begin, size_t end, size_t chunkRows = 1 << 16);
+
+    /** @brief Parent rows in several [begin, end) ranges, visited in order */
+    dataset_view(dataset &parent, vector<pair<size_t, size_t>> ranges, size_t chunkRows = 1 << 16);
+
+    /** @brief The listed parent rows, in order (repeats allowed) */
+    dataset_view(dataset &parent, vector<size_t> rows, size_t chunkRows = 1 << 16);
+
+    /** @brief Number of rows in the view */
+    size_t rows() { return total; }
+
+    /** @brief Whether the rows are ranges rather than an index list */
+    bool isRanged() { return !index; }
+
+    /** @brief Parent row of the view's row `i` */
+    size_t parentRow(size_t i);
+
+    /** @brief Feature row `i`, like dataset::getRow */
+    vector<double> getRow(size_t i);
+
+    /** @brief Choose feature columns of the parent by name or index (see dataset::chooseX) */
+    dataset_view &chooseX(const vector<variant<string, int>> &);
+
+    /** @brief Choose the target column of the parent by name or index */
+    dataset_view &chooseY(variant<string, int>);
+
+    size_t features() override { return settings.x.size(); }
+    void rewind() override;
+    bool next(batch &out) override;
+    size_t peakBytes() override { return peak; }
+    vector<string> featureNames() override;
+};
+
+/**
+ * @brief Fold `fold` of `k` contiguous folds: {training rows, held-out rows}
+ *
+ * Both views are ranges, so any number of splits costs O(1) memory each.
+ */
+pair<dataset_view, dataset_view> kfold_split(dataset &data, size_t k, size_t fold);
+
+/** @brief {first rows, last `testFraction` of the rows}, both ranges */
+pair<dataset_view, dataset_view> train_test_split(dataset &data, double testFraction);
+
+/** @brief The same split over a shuffled row order (two index lists) */
+pair<dataset_view, dataset_view> train_test_split(dataset &data, double testFraction, unsigned seed);
+
+#endif // HOMEMADESCIKIT_DATASET_VIEW_H
@@ -0,0 +1,234 @@
+#ifndef HOMEMADESCIKIT_FIXED_MODEL_H
+#define HOMEMADESCIKIT_FIXED_MODEL_H
+
+#include <array>
+#include <utility>
+#include <stdexcept>
+#include "model.h"
+#include "kernels.h"
+
+using namespace std;
+
+/** @brief Call f(0), f(1), ... f(D - 1) with compile-time indices */
+template <class F, size_t... I>
+inline void unrolled(F &&f, index_sequence<I...>)
+{
+    (f(integral_constant<size_t, I>()), ...);
+}
+
+template <size_t D, class F>
+inline void unrolled(F &&f)
+{
+    unrolled(f, make_index_sequence<D>());
+}
+
+/**
+ * @brief Linear-model kernels for exactly D features
+ *
+ * Every loop over the features is unrolled at compile time and the
+ * weights live in registers for a whole call, so nothing is paid per row
+ * for the feature count. Sums run in the same order as the generic
+ * scalar code (b first, then the features in weight order), so the
+ * row-wise results match it bit for bit.
+ */
+template <size_t D>
+struct fixed_kernel
+{
+    static_assert(D > 0, "fixed_kernel needs at least one feature");
+
+    static double predict(const double *w, double b, const double *x)
+    {
+        double s = b;
+        unrolled<D>([&](auto j)
+                    { s += x[j] * w[j]; });
+        return s;
+    }
+
+    static void predictRows(const double *x, size_t count, size_t stride, const double *w, double b, double *out)
+    {
+        array<double, D> wl;
+        unrolled<D>([&](auto j)
+                    { wl[j] = w[j]; });
+        for (size_t i = 0; i < count; i++)
+            out[i] = predict(wl.data(), b, x + i * stride);
+    }
+
+    static void predictColumns(const batch &rows, const double *w, double b, double *out)
+    {
+        array<const double *, D> x;
+        array<double, D> wl;
+        unrolled<D>([&](auto j)
+                    { x[j] = rows.x[j]; wl[j] = w[j]; });
+        for (size_t i = 0; i < rows.rows; i++)
+        {
+            double s = b;
+            unrolled<D>([&](auto j)
+                        { s += wl[j] * x[j][i]; });
+            out[i] = s;
+        }
+    }
+
+    /** @brief fused_gradient() for D features (the same outputs and contract) */
+    static void fusedGradient(const batch &rows, const double *w, double b, double *gw, double &gb, double &cost)
+    {
+        array<const double *, D> x;
+        array<double, D> wl, g{};
+        unrolled<D>([&](auto j)
+                    { x[j] = rows.x[j]; wl[j] = w[j]; });
+
+        double sb = 0, sc = 0;
+        for (size_t i = 0; i < rows.rows; i++)
+        {
+            double r = b - rows.y[i];
+            unrolled<D>([&](auto j)
+                        { r += wl[j] * x[j][i]; });
+            unrolled<D>([&](auto j)
+                        { g[j] += r * x[j][i]; });
+            sb += r;
+            sc += r * r;
+        }
+
+        if (gw)
+            unrolled<D>([&](auto j)
+                        { gw[j] += g[j]; });
+        gb += sb;
+        cost += sc;
+    }
+
+    /**
+     * @brief One SGD step per row, visiting rows `order[0 .. count)`
+     *
+     * With `scale` set, steps are taken in the scaled feature space and
+     * mapped back onto the raw weights, like model training does.
+     */
+    static void sgdRows(const batch &rows, const size_t *order, size_t count, double a, const double *shift,
+                        const double *scale, double *w, double &b, double &cost)
+    {
+        array<const double *, D> x;
+        array<double, D> wl, sq{}, s{};
+        unrolled<D>([&](auto j)
+                    {
+            x[j] = rows.x[j];
+            wl[j] = w[j];
+            if (scale)
+            {
+                sq[j] = scale[j] * scale[j];
+                s[j] = shift[j];
+            } });
+
+        double bl = b, sc = cost;
+        for (size_t n = 0; n < count; n++)
+        {
+            size_t i = order[n];
+            double r = bl - rows.y[i];
+            unrolled<D>([&](auto j)
+                        { r += wl[j] * x[j][i]; });
+            if (!scale)
+            {
+                unrolled<D>([&](auto j)
+                            { wl[j] -= a * r * x[j][i]; });
+                bl -= a * r;
+            }
+            else
+            {
+                double db = 0;
+                unrolled<D>([&](auto j)
+                            {
+                    double dw = a * r * (x[j][i] - s[j]) / sq[j];
+                    wl[j] -= dw;
+                    db += dw * s[j]; });
+                bl -= a * r - db;
+            }
+            sc += r * r;
+        }
+
+        unrolled<D>([&](auto j)
+                    { w[j] = wl[j]; });
+        b = bl;
+        cost = sc;
+    }
+
+    static const fixed_kernels table;
+};
+
+template <size_t D>
+const fixed_kernels fixed_kernel<D>::table = {
+    D,
+    fixed_kernel<D>::predict,
+    fixed_kernel<D>::predictRows,
+    fixed_kernel<D>::predictColumns,
+    fixed_kernel<D>::fusedGradient,
+    fixed_kernel<D>::sgdRows,
+};
+
+/**
+ * @brief A trained linear model frozen at exactly D features
+ *
+ * Holds its weights in a `std::array` and scores through fixed_kernel<D>,
+ * for serving small models where the generic `vector` paths cost more
+ * than the arithmetic. Copy one out of a trained (or imported) model:
+ *
+ *     fixed_model<3> f(m);
+ *     double y = f.predict({1.0, 2.0, 3.0});
+ *
+ * Features are in weight order, as for model::predict.
+ */
+template <size_t D>
+class fixed_model
+{
+private:
+    array<double, D> w{};
+    double b = 0;
+
+public:
+    fixed_model() = default;
+
+    /** @brief Copy the weights of `m`, which must have exactly D features */
+    explicit fixed_model(model &m)
+    {
+        const vector<double> &weights = m.getW();
+        if (weights.size() != D)
+            throw runtime_error("fixed_model: the model has " + to_string(weights.size()) + " features, not " +
+                                to_string(D));
+        for (size_t j = 0; j < D; j++)
+            w[j] = weights[j];
+        b = m.getB();
+    }
+
+    /** @brief Predict one row */
+    double predict(const array<double, D> &x) const { return fixed_kernel<D>::predict(w.data(), b, x.data()); }
+
+    /** @brief Predict one row given as D contiguous values */
+    double predict(const double *x) const { return fixed_kernel<D>::predict(w.data(), b, x); }
+
+    /**
+     * @brief Score `count` row-major rows laid out `stride` doubles apart
+     * @param out Caller-provided buffer of `size` == count values
+     */
+    void predict(const double *rows, size_t count, size_t stride, double *out, size_t size) const
+    {
+        if (stride < D)
+            throw runtime_error("predict: row stride smaller than the feature count");
+        if (size != count)
+            throw runtime_error("predict: output size mismatch");
+        fixed_kernel<D>::predictRows(rows, count, stride, w.data(), b, out);
+    }
+
+    /**
+     * @brief Score a column-major view (one pointer per feature, weight order)
+     * @param out Caller-provided buffer of `size` == columns.rows values
+     */
+    void predict(const batch &columns, double *out, size_t size) const
+    {
+        if (columns.x.size() != D)
+            throw runtime_error("predict: input size mismatch");
+        if (size != columns.rows)
+            throw runtime_error("predict: output size mismatch");
+        fixed_kernel<D>::predictColumns(columns, w.data(), b, out);
+    }
+
+    const array<double, D> &getW() const { return w; }
+    double getB() const { return b; }
+};
+
+#endif // HOMEMADESCIKIT_FIXED_MODEL_H
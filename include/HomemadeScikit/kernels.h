@@ -0,0 +1,74 @@
+#ifndef HOMEMADESCIKIT_KERNELS_H
+#define HOMEMADESCIKIT_KERNELS_H
+
+#include <cstddef>
+#include "row_source.h"
+
+using namespace std;
+
+/**
+ * @brief One fused pass of linear-regression training over a batch
+ *
+ * For every row the residual r = w·x + b - y is computed exactly once and
+ * then used for everything: gw[j] += r * x[j], gb += r and cost += r².
+ * Rows are processed in small blocks so the residuals stay in L1 while
+ * each feature column is streamed twice (once to build them, once for its
+ * gradient), which keeps the pass O(rows · features).
+ *
+ * Results are accumulated into the outputs; the caller zeroes them and
+ * scales by the row count. Pass gw == nullptr to accumulate only gb and
+ * the cost.
+ */
+void fused_gradient(const batch &rows, const double *w, double b, double *gw, double &gb, double &cost);
+
+/**
+ * @brief The same pass over float columns with float weights
+ *
+ * Residuals are formed in float, twice as many per vector register. The
+ * per-block reductions accumulate in double when `wide` is set and in
+ * float otherwise; blocks are always summed into the double outputs.
+ */
+void fused_gradient(const batch_f &rows, const float *w, float b, double *gw, double &gb, double &cost, bool wide);
+
+/**
+ * @brief Score a column-major block: out[i] = w·x_i + b (rows.y is ignored)
+ *
+ * Works through row blocks, accumulating one feature column at a time into
+ * the output block while it sits in L1.
+ */
+void predict_columns(const batch &rows, const double *w, double b, double *out);
+
+/** @brief The same over float columns, computed in float and widened into `out` */
+void predict_columns(const batch_f &rows, const float *w, float b, double *out);
+
+/**
+ * @brief Score row-major rows: out[i] = w·x[i * stride .. + d) + b
+ */
+void predict_rows(const double *x, size_t count, size_t d, size_t stride, const double *w, double b, double *out);
+
+/** @brief Largest feature count with compile-time specialized kernels */
+const size_t FIXED_MAX_FEATURES = 8;
+
+/**
+ * @brief Kernels specialized for one small feature count
+ *
+ * Built from fixed_kernel<D> (see fixed_model.h), with every feature loop
+ * unrolled. They are scalar per row: they beat the vector kernels above
+ * where per-row or per-call overhead dominates (single rows, row-major
+ * rows, small blocks, SGD), not on long column scans.
+ */
+typedef struct fixed_kernels
+{
+    size_t features;
+    double (*predict)(const double *w, double b, const double *x);
+    void (*predictRows)(const double *x, size_t count, size_t stride, const double *w, double b, double *out);
+    void (*predictColumns)(const batch &rows, const double *w, double b, double *out);
+    void (*fusedGradient)(const batch &rows, const double *w, double b, double *gw, double &gb, double &cost);
+    void (*sgdRows)(const batch &rows, const size_t *order, size_t count, double a, const double *shift,
+                    const double *scale, double *w, double &b, double &cost);
+} fixed_kernels;
+
+/** @brief The specialized kernels for `d` features, or nullptr outside 1..FIXED_MAX_FEATURES */
+const fixed_kernels *fixed_kernels_for(size_t d);
+
+#endif // HOMEMADESCIKIT_KERNELS_H
@@ -0,0 +1,49 @@
+#ifndef HOMEMADESCIKIT_LINALG_H
+#define HOMEMADESCIKIT_LINALG_H
+
+#include <cstddef>
+#include "row_source.h"
+
+using namespace std;
+
+/*
+ * Closed-form least squares over the augmented rows z = [x_0 .. x_{d-1}, 1, y].
+ * Every matrix below is k x k with k = d + 2, stored row-major, and only its
+ * upper triangle is meaningful. The solution theta holds the d weights
+ * followed by the bias. Float batches are accumulated in double.
+ */
+
+/**
+ * @brief Add ZᵀZ of a batch to the Gram matrix G
+ *
+ * Rows are taken in small tiles so that the d + 2 column slices of a tile
+ * stay in cache while all of their pairwise dot products are formed.
+ */
+void gram_update(const batch &rows, double *G);
+void gram_update(const batch_f &rows, double *G);
+
+/** @brief Solve the normal equations held in G by Cholesky; false if not positive definite */
+bool cholesky_solve(const double *G, size_t d, double *theta);
+
+/**
+ * @brief Fold a batch into the triangular factor R of Z (tall-skinny QR)
+ *
+ * Each tile of rows is stacked under R and re-triangularised with
+ * Householder reflections, so R always satisfies RᵀR = ZᵀZ without the
+ * squared condition number of the Gram matrix.
+ */
+void tsqr_update(const batch &rows, double *R);
+void tsqr_update(const batch_f &rows, double *R);
+
+/** @brief Fold another factor (e.g. from a different row range) into R */
+void tsqr_merge(double *R, const double *other, size_t d);
+
+/**
+ * @brief Solve the least-squares problem held in R by back substitution
+ *
+ * Directions with a negligible pivot (constant or duplicated columns) get a
+ * zero coefficient instead of failing. Returns false if R is empty.
+ */
+bool triangular_solve(const double *R, size_t d, double *theta);
+
+#endif // HOMEMADESCIKIT_LINALG_H
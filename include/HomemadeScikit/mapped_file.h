@@ -0,0 +1,44 @@
+#ifndef HOMEMADESCIKIT_MAPPED_FILE_H
+#define HOMEMADESCIKIT_MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief Read-only view of a whole file mapped into memory.
+ *
+ * The mapping lives as long as the object; `view()` hands out the bytes
+ * without copying them. On platforms without mmap the file is read into
+ * an owned buffer instead, so callers never need to care which one they got.
+ */
+class mapped_file
+{
+private:
+    const char *bytes;
+    size_t length;
+    bool mapped;
+
+    void release();
+
+public:
+    /** @brief Map `filename`; throws runtime_error if it cannot be opened */
+    explicit mapped_file(const string &filename);
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /** @brief Pointer to the first byte (may be null for an empty file) */
+    const char *data() const { return bytes; }
+
+    /** @brief Size of the file in bytes */
+    size_t size() const { return length; }
+
+    /** @brief The file contents as a string_view */
+    string_view view() const { return string_view(bytes, length); }
+};
+
+#endif // HOMEMADESCIKIT_MAPPED_FILE_H
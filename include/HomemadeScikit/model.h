@@ -3,7 +3,16 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <random>
+#include <functional>
+#include <cmath>
+#include <atomic>
 #include "dataset.h"
+#include "row_source.h"
+#include "thread_pool.h"
+#include "observer.h"
+#include "kernels.h"
 
 using namespace std;
 
@@ -13,15 +22,106 @@ typedef struct grad
     double b;
 } grad;
 
+/**
+ * @brief Training configuration
+ *
+ * - `algo` is "gradient" (full batch), "minibatch" (one step per block of
+ *   `batch` rows), "sgd" (one step per row), or one of the closed-form
+ *   solvers "normal" (Cholesky on XᵀX) and "qr" (tall-skinny QR of X, for
+ *   ill-conditioned features); the solvers make a single pass and ignore
+ *   `epochs` and `step`
+ * - `threads` splits every pass over the rows into that many contiguous
+ *   ranges computed in parallel (0 = all cores). Partial sums are combined
+ *   in range order, so results are bit-reproducible for a given count.
+ *   `pool`, when set, runs them on that pool instead (one shared by many
+ *   models, as grid_search does), split into as many ranges as it has
+ *   threads; it must outlive the call.
+ * - `batch` and `seed` drive "minibatch" and "sgd": each epoch visits the
+ *   contiguous blocks of `batch` rows in a freshly shuffled order (and,
+ *   for "sgd", the rows of each block in shuffled order too), so the data
+ *   is still read a block at a time rather than one scattered row at a time
+ * - `observer`, when set, is handed an `epoch_stats` record every
+ *   `interval` epochs; it must outlive the call to train()
+ * - the iterative algorithms stop before `epochs` once the relative change
+ *   in cost stays below `tolerance` for `patience` epochs in a row, once
+ *   the gradient norm drops below `gradTolerance` ("gradient" only), or
+ *   once `timeLimit` seconds have passed; 0 disables a criterion. The cost
+ *   checked is the one the epoch's own pass computed. Setting `*cancel`
+ *   (from an observer or another thread) stops them after the epoch that
+ *   sees it.
+ * - `scale` is "none", "standardize" (mean 0, variance 1) or "minmax"
+ *   (range [0, 1]): the iterative algorithms then step in the scaled
+ *   feature space, so one `step` suits features of any magnitude. The
+ *   transform is fitted from the column statistics when training starts
+ *   and recorded in the model; the rows themselves are never rewritten.
+ * - on a dataset whose chosen columns are float (see
+ *   load_settings.precision), passes run the single-precision kernels
+ *   against a float copy of the weights; `wideSums` keeps their dot
+ *   products and sums in double. The weights themselves stay double.
+ * - with 1 to FIXED_MAX_FEATURES features, `specialize` lets the per-row
+ *   work ("sgd" steps and small "minibatch" blocks) run kernels unrolled
+ *   for that exact count (see fixed_model.h); long full-batch passes keep
+ *   the vector kernels, which are faster there.
+ * - category columns of a dataset (see load_settings.infer) are expanded
+ *   on the fly, never into a dense matrix: `encoding` "onehot" gives each
+ *   level its own weight, read by the row's code; "target" replaces the
+ *   level by the mean target of its rows, pulled toward the overall mean
+ *   as if `smoothing` more rows had that mean, with one weight for the
+ *   feature. Such models train with "gradient", `scale` "none", on one
+ *   thread.
+ */
 typedef struct model_settings
 {
     string algo = "gradient";
     int epochs = 1000;
     double step = 0.001;
+    int threads = 1;
+    int batch = 256;
+    unsigned seed = 0;
+    train_observer *observer = nullptr;
+    int interval = 1;
+    double tolerance = 0;
+    double gradTolerance = 0;
+    int patience = 1;
+    double timeLimit = 0;
+    const atomic<bool> *cancel = nullptr;
+    thread_pool *pool = nullptr;
+    string scale = "none";
+    bool wideSums = true;
+    bool specialize = true;
+    string encoding = "onehot";
+    double smoothing = 10;
 } model_settings;
 
+/** @brief Why training ended */
+enum stop_reason
+{
+    STOP_EPOCHS,        // ran the full epoch budget
+    STOP_COST,          // relative cost change under `tolerance`
+    STOP_GRADIENT,      // gradient norm under `gradTolerance`
+    STOP_TIME,          // `timeLimit` reached
+    STOP_SOLVED,        // closed-form solution, a single pass
+    STOP_CANCELLED      // `*cancel` was set
+};
+
+/** @brief Lower-case name of a stop reason ("epochs", "cost", ...) */
+const char *stop_reason_name(stop_reason reason);
+
+/** @brief Outcome of a call to model::train */
+typedef struct train_report
+{
+    stop_reason reason = STOP_EPOCHS;
+    int epochs = 0;     // passes actually made over the data
+    double cost = NAN;  // J once training ended
+    double seconds = 0; // wall time of the call
+} train_report;
+
 /**
  * @brief Linear regression model using gradient descent
+ *
+ * The training rows come either from an in-memory `dataset` or from a
+ * `row_source` that streams them in bounded batches, for data that does
+ * not fit in memory.
  */
 class model
 {
@@ -29,34 +129,259 @@ private:
     vector<double> w;
     double b;
     double J;
+    vector<string> names; // feature headers, in weight order
+
+    // feature transform x' = (x - shift) / scale, empty when "none". w and b
+    // always act on raw features (the transform is folded into them), so
+    // every prediction path applies it for free; training uses it to step
+    // in the scaled space.
+    string scaling = "none";
+    vector<double> shift;
+    vector<double> scale;
+
+    void fitTransform(const model_settings &m);
+
+    // sufficient statistics: ZᵀZ over every row folded in so far, with
+    // z = [x, 1, y] (see linalg.h), so it holds XᵀX, Xᵀy, the sums and the
+    // row count. Empty when unknown (after an iterative train()).
+    vector<double> gram;
+
+    void beginStatistics(size_t features);
+    void statisticsTransform(const model_settings &m);
+    void statisticsGrad(grad &out, double &cost);
+    train_report refit(const model_settings &m, const stopwatch &started);
     int n;
-    dataset &mydata;
+    dataset *mydata;
+    row_source *source;
+
+    // reused across epochs so a training step allocates nothing
+    batch rows;
+    grad gradient;
+
+    // float columns: their batch, the weights narrowed for the float
+    // kernels, and whether those accumulate in double
+    batch_f rowsF;
+    vector<float> wf;
+    bool wide = true;
+
+    // kernels unrolled for the feature count, when training may use them
+    const fixed_kernels *fixed = nullptr;
+
+    // category features, at `position` among the d inputs. "onehot" keeps
+    // a weight per level in w[offset + code], after the d input weights
+    // (whose own slot stays 0); "target" scales encoded[code] (the last
+    // entry, the overall mean, stands for missing and unseen levels) by
+    // the feature's weight
+    typedef struct category_feature
+    {
+        size_t position;
+        shared_ptr<const vector<string>> levels;
+        size_t offset = 0;
+        vector<double> encoded;
+    } category_feature;
+    vector<category_feature> categories;
+    vector<int> categoryAt; // per input, index into `categories` or -1
+    string encoding;
+    size_t inputs = 0; // d; w.size() for a model without categories
+    vector<const uint32_t *> codes;
+    vector<vector<uint32_t>> remap;
+    vector<double> residuals;
+
+    void encodeCategories(const model_settings &m);
+    void categoricalPass(dataset &data, double *gw, double &gb, double &cost, double *out);
+
+    static bool floatColumns(dataset &data);
+    void narrowWeights();
+    void fused(const batch &rows, double *gw, double &gb, double &cost);
+    void fused(const batch_f &rows, double *gw, double &gb, double &cost);
+
+    // data-parallel passes: one slice of the batch and one row of partial
+    // sums (gradient, bias, cost) per thread
+    unique_ptr<thread_pool> owned;
+    thread_pool *pool = nullptr;
+    vector<batch> parts;
+    vector<batch_f> partsF;
+    vector<double> partials;
+
+    template <class T>
+    void split(const basic_batch<T> &rows, size_t t, vector<basic_batch<T>> &parts);
+    template <class T>
+    void accumulate(const basic_batch<T> &rows, double *gw, double &gb, double &cost);
+
+    // shuffled block order and in-block row order for the stochastic paths
+    vector<size_t> order;
+    vector<size_t> rowOrder;
+
+    template <class T>
+    void stochasticEpoch(const basic_batch<T> &rows, const model_settings &m, mt19937_64 &rng, double &cost);
+    void stochasticDescent(const model_settings &m);
 
-    void gradientIter(const double a);
-    void logValues(int i);
-    grad calculateGrad();
-    void gradientDescent(const int n, const double a);
+    void importBinary(const string &filename);
+
+    template <class T>
+    void factorize(const basic_batch<T> &rows, bool qr, double *S);
+    template <class T>
+    void predictBatch(const basic_batch<T> &columns, double *out, size_t size);
+    void solveClosedForm(const model_settings &m);
+
+    void gradientIter(const grad &gradient, const double a);
+    void notify(const model_settings &m, int epoch, double gradNorm, double passSeconds, double updateSeconds);
+
+    // early stopping: the previous epoch's cost and how many epochs in a
+    // row have moved it less than the tolerance
+    train_report outcome;
+    double previousJ = NAN;
+    int calm = 0;
+
+    bool shouldStop(const model_settings &m, int epoch, double gradNorm, const stopwatch &started);
+    static void datasetBatch(dataset &data, batch &rows);
+    static void datasetBatch(dataset &data, batch_f &rows);
+    void usePool(const model_settings &m);
+    void forRanges(size_t count, const function<void(size_t, size_t)> &fn);
+    void pass(double *gw, double &gb, double &cost);
+    void calculateGrad(grad &out, double &cost);
+    void gradientDescent(const model_settings &m);
 
 public:
+    /** @brief Empty model, to be filled by import() */
+    model();
+
     /** @brief Initialize model from dataset */
     model(dataset &);
 
-    /** @brief Predict output for given features */
+    /**
+     * @brief Initialize model over a streamed source
+     *
+     * The source must outlive the model. Nothing is read until training
+     * (or calcJ()), so getJ() is NaN until then. A dataset_view trains
+     * this way on a subset of a dataset's rows without copying them.
+     */
+    model(row_source &);
+
+    /**
+     * @brief Predict output for given features
+     *
+     * With 1 to FIXED_MAX_FEATURES features, this and the batch overloads
+     * below score through kernels unrolled for that count; fixed_model<D>
+     * does the same without the runtime dispatch.
+     */
     double predict(const vector<double> &);
 
+    /**
+     * @brief Score every row of a dataset, using its `settings.x` as features
+     * @param out Caller-provided buffer of `size` == data.rows() values
+     *
+     * For a model with category features, each category column of `data`
+     * is matched to the training one by level name, so it may come from
+     * another file; levels the model has not seen contribute nothing.
+     * The overloads below that take plain numbers do not accept such a
+     * model, except predict(vector), which reads codes of the training
+     * dictionary (as getRow on the training dataset gives them).
+     */
+    void predict(dataset &data, double *out, size_t size);
+
+    /**
+     * @brief Score a column-major view (one pointer per feature, weight order)
+     * @param out Caller-provided buffer of `size` == columns.rows values
+     */
+    void predict(const batch &columns, double *out, size_t size);
+    void predict(const batch_f &columns, double *out, size_t size);
+
+    /**
+     * @brief Score every row a source yields in one pass (e.g. a dataset_view)
+     * @param out Caller-provided buffer of `size` == the source's row count
+     */
+    void predict(row_source &rows, double *out, size_t size);
+
+    /**
+     * @brief Score `count` row-major rows laid out `stride` doubles apart
+     * @param out Caller-provided buffer of `size` == count values
+     */
+    void predict(const double *rows, size_t count, size_t stride, double *out, size_t size);
+
+    /** @brief Threads used by training and batch prediction (0 = all cores) */
+    void setThreads(int);
+
     /** @brief Calculate cost function */
     void calcJ();
 
+    /** @brief Cost of the current weights over other rows (e.g. a held-out dataset_view); getJ() is unchanged */
+    double calcJ(row_source &rows);
+
     /** @brief Get current cost */
     double getJ() { return J; }
 
-    /** @brief Train the model */
-    void train(const model_settings &);
+    /** @brief Peak bytes held by the streamed source (0 for a dataset) */
+    size_t getPeakBytes() { return source ? source->peakBytes() : 0; }
+
+    /** @brief Train the model; the report says how many epochs ran and why it stopped */
+    train_report train(const model_settings &);
+
+    /**
+     * @brief Fold new rows into the running statistics and update the fit
+     *
+     * Only the new rows are read: their XᵀX, Xᵀy and sums are added to the
+     * statistics kept in the model, then the weights are refitted from the
+     * statistics alone, in O(d³) for `algo` "normal" (the exact least
+     * squares solution over every row seen so far) or O(epochs · d²) for
+     * "gradient", warm-started from the current weights (`scale` may be
+     * "none" or "standardize"; early stopping and the observer work as in
+     * train()). getJ() is then the cost over every row seen.
+     *
+     * The statistics start from those of the last closed-form train() (an
+     * iterative train() drops them) and travel with export_binary. If
+     * "normal" cannot solve yet (fewer rows than features, or collinear
+     * ones), it throws with the rows kept, and the weights unchanged.
+     */
+    train_report partial_fit(dataset &rows, const model_settings &m = {"normal"});
+    train_report partial_fit(row_source &rows, const model_settings &m = {"normal"});
+    train_report partial_fit(const batch &rows, const model_settings &m = {"normal"});
 
-    /** @brief Export model to file */
+    /** @brief Rows held in the running statistics (0 when there are none) */
+    size_t getSeen();
+
+    /** @brief Report of the last train() call */
+    const train_report &getReport() { return outcome; }
+
+    /** @brief Export model to a text file (.anouar), at full double precision */
     void export_to_file(string);
 
+    /**
+     * @brief Export model to a versioned binary file (.hsm)
+     *
+     * Layout: a 48-byte header (magic, version, byte-order marker, feature
+     * count, name table size, word-wise FNV-1a checksum of everything
+     * after the header, flags), then b and w as raw little-endian doubles,
+     * the feature names as (uint32 length, bytes) pairs, then, when the
+     * flags say so, the transform's shift and scale vectors and the upper
+     * triangle of the partial_fit statistics, row by row. The text format
+     * does not keep the statistics.
+     */
+    void export_binary(string);
+
+    /**
+     * @brief Load weights from a file written by export_to_file or export_binary
+     *
+     * Binary files are recognised by their magic and read through a memory
+     * mapping; nothing is parsed beyond the fixed header.
+     */
     void import(string);
+
+    /** @brief Trained weights, in feature order, then any one-hot level weights */
+    const vector<double> &getW() { return w; }
+
+    /** @brief Trained bias */
+    double getB() { return b; }
+
+    /** @brief Recorded feature transform: "none", "standardize" or "minmax" */
+    const string &getScaling() { return scaling; }
+
+    /** @brief Per-feature shift and scale of the transform (empty for "none") */
+    const vector<double> &getShift() { return shift; }
+    const vector<double> &getScale() { return scale; }
+
+    /** @brief Feature headers, in weight order (one-hot levels as "header=level"; empty if unknown) */
+    const vector<string> &getNames() { return names; }
 };
 
 #endif // HOMEMADESCIKIT_MODEL_H
@@ -0,0 +1,106 @@
+#ifndef HOMEMADESCIKIT_OBSERVER_H
+#define HOMEMADESCIKIT_OBSERVER_H
+
+#include <string>
+#include <fstream>
+#include <ostream>
+#include <chrono>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief What one training epoch looked like
+ *
+ * `cost` is the J computed by the epoch's own pass (the cost at the
+ * weights the epoch started from for "gradient", the running cost seen
+ * while the weights moved for "minibatch"/"sgd"). `gradNorm` is the norm
+ * of the full gradient over w and b; the stochastic paths never form it
+ * and report NaN. `passSeconds` covers reading the rows and computing the
+ * gradient, `updateSeconds` applying the step (or solving, for the
+ * closed-form algorithms, which report a single epoch 0).
+ */
+typedef struct epoch_stats
+{
+    int epoch;
+    double cost;
+    double gradNorm;
+    double passSeconds;
+    double updateSeconds;
+    size_t rows;
+    double rowsPerSec;
+} epoch_stats;
+
+/**
+ * @brief Receives training telemetry
+ *
+ * Set through `model_settings.observer`. With no observer the training
+ * loops read no clocks and build no records.
+ */
+class train_observer
+{
+public:
+    virtual ~train_observer() = default;
+
+    /** @brief Called after every `model_settings.interval`-th epoch */
+    virtual void onEpoch(const epoch_stats &stats) = 0;
+};
+
+/** @brief Wall-clock timer for the training phases */
+class stopwatch
+{
+private:
+    chrono::steady_clock::time_point start;
+
+public:
+    stopwatch() : start(chrono::steady_clock::now()) {}
+
+    /** @brief Seconds since construction or the previous lap */
+    double elapsed() const
+    {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    /** @brief Seconds since construction or the previous lap, and restart */
+    double lap()
+    {
+        auto now = chrono::steady_clock::now();
+        double seconds = chrono::duration<double>(now - start).count();
+        start = now;
+        return seconds;
+    }
+};
+
+/**
+ * @brief Writes one line per reported epoch as CSV (with a header line) or
+ * JSON lines
+ *
+ * Either owns a file or writes to a caller's stream, which must outlive
+ * the sink.
+ */
+class log_sink : public train_observer
+{
+public:
+    enum format
+    {
+        CSV,
+        JSONL
+    };
+
+private:
+    ofstream file;
+    ostream *out;
+    format kind;
+    bool headerWritten = false;
+
+public:
+    /** @brief Log to `filename`, truncating it */
+    log_sink(const string &filename, format kind = CSV);
+
+    /** @brief Log to an existing stream */
+    log_sink(ostream &out, format kind = CSV);
+
+    void onEpoch(const epoch_stats &stats) override;
+};
+
+#endif // HOMEMADESCIKIT_OBSERVER_H
@@ -0,0 +1,218 @@
+#ifndef HOMEMADESCIKIT_ROW_SOURCE_H
+#define HOMEMADESCIKIT_ROW_SOURCE_H
+
+#include <vector>
+#include <string>
+#include <variant>
+#include <fstream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <cstddef>
+#include "dataset.h"
+
+using namespace std;
+
+/**
+ * @brief A block of consecutive rows handed to the training kernels
+ *
+ * `x` holds one pointer per feature, in model weight order (the order of
+ * dataset::getRow), each to `rows` values; `y` points to the targets.
+ * Missing cells read as 0.0, as they do in a dataset. `batch` views double
+ * columns and `batch_f` float ones; sources always yield `batch`.
+ */
+template <class T>
+struct basic_batch
+{
+    size_t rows = 0;
+    vector<const T *> x;
+    const T *y = nullptr;
+};
+
+typedef basic_batch<double> batch;
+typedef basic_batch<float> batch_f;
+
+/**
+ * @brief Sequential, bounded-memory supplier of training rows
+ *
+ * A source yields the rows of one pass in batches; `rewind()` starts the
+ * next pass. The pointers in a batch stay valid until the next call to
+ * `next()` or `rewind()`.
+ */
+class row_source
+{
+public:
+    virtual ~row_source() {}
+
+    /** @brief Number of feature columns in every batch */
+    virtual size_t features() = 0;
+
+    /** @brief Restart from the first row */
+    virtual void rewind() = 0;
+
+    /** @brief Fill `out` with the next batch; false once the pass is over */
+    virtual bool next(batch &out) = 0;
+
+    /** @brief Largest number of bytes the source has held at once */
+    virtual size_t peakBytes() = 0;
+
+    /** @brief Header of every feature column, in batch order */
+    virtual vector<string> featureNames() = 0;
+};
+
+/**
+ * @brief Streams a CSV file through a fixed-size read buffer
+ *
+ * Only the selected columns are parsed; each batch holds as many rows as
+ * fit in `maxBytes` together with the read buffer.
+ */
+class csv_source : public row_source
+{
+private:
+    string filename;
+    ifstream file;
+    string buffer;
+    size_t pos;
+    bool eof;
+    size_t chunkBytes;
+    size_t batchRows;
+    size_t peak;
+
+    vector<int> slot;                // CSV column -> buffer index, -1 if unused
+    vector<vector<double>> columns;  // features in weight order, then the target
+    vector<string> names;
+    size_t nx;
+
+    bool refill();
+    void parseLine(const char *p, const char *end, size_t row);
+    void track();
+
+public:
+    /**
+     * @param filename CSV file with a header line
+     * @param x Feature columns, by name or index
+     * @param y Target column, by name or index
+     * @param maxBytes Memory ceiling for the read buffer plus one batch
+     */
+    csv_source(string filename, const vector<variant<string, int>> &x, variant<string, int> y, size_t maxBytes = 64 << 20);
+
+    size_t features() override { return nx; }
+    void rewind() override;
+    bool next(batch &out) override;
+    size_t peakBytes() override { return peak; }
+    vector<string> featureNames() override { return names; }
+};
+
+/**
+ * @brief Streams a binary dataset (.hsd) straight from its mapping
+ *
+ * Batches point into the mapped file; pages of a finished batch are handed
+ * back to the OS, so the resident set stays around one batch.
+ */
+class binary_source : public row_source
+{
+private:
+    dataset data;
+    vector<const double *> x;
+    const double *y;
+    size_t pos;
+    size_t batchRows;
+    size_t peak;
+
+    void release(size_t begin, size_t end);
+
+public:
+    /**
+     * @param filename Binary dataset written by dataset::save_binary
+     * @param x Feature columns, by name or index
+     * @param y Target column, by name or index
+     * @param maxBytes Memory ceiling for one batch
+     */
+    binary_source(string filename, const vector<variant<string, int>> &x, variant<string, int> y, size_t maxBytes = 64 << 20);
+
+    size_t features() override { return x.size(); }
+    void rewind() override;
+    bool next(batch &out) override;
+    size_t peakBytes() override { return peak; }
+    vector<string> featureNames() override;
+};
+
+/**
+ * @brief Reads another source on a background thread, a few batches ahead
+ *
+ * A reader thread pulls batches from `inner` and copies them into a ring
+ * of `blocks` row blocks (two by default: one being filled while the
+ * trainer works on the other), handed over through a bounded lock-free
+ * single-producer, single-consumer queue; a side that finds the queue
+ * full (or empty) spins briefly, then sleeps until the other side hands
+ * a block over, so neither takes a core from the training passes while
+ * it waits. Parsing a CSV thus overlaps
+ * the training steps on the rows already read, and the first steps (or
+ * partial_fit statistics) start before the file has been read through.
+ *
+ * Reading starts as soon as the source is built. rewind() restarts the
+ * reader, unless nothing of the current pass has been taken yet, so the
+ * rewind a model does before its first pass keeps what was read ahead.
+ * An exception thrown by `inner` is rethrown by next(). `inner` must
+ * outlive this source and not be used directly while it is running.
+ */
+class async_source : public row_source
+{
+private:
+    // one batch-sized block of rows: features in batch order, then the target
+    typedef struct block
+    {
+        size_t rows = 0;
+        vector<vector<double>> columns;
+    } block;
+
+    row_source &inner;
+    size_t nx;
+    vector<string> names;
+
+    // the reader fills ring[head % size], the trainer reads ring[tail % size];
+    // each side writes only its own index
+    vector<block> ring;
+    atomic<size_t> head;
+    atomic<size_t> tail;
+    atomic<bool> finished;
+    atomic<bool> stopping;
+    atomic<size_t> ringBytes;
+    atomic<size_t> innerPeak;
+    exception_ptr error;
+    thread reader;
+
+    // wakes a side sleeping on the queue; the indices stay lock-free
+    mutex sleepers;
+    condition_variable moved;
+
+    template <class Ready>
+    void await(Ready ready);
+    void wake();
+    bool holding = false; // the trainer still uses ring[tail % size]
+
+    void produce();
+    void start();
+    void stop();
+
+public:
+    /**
+     * @param inner Source to read ahead from
+     * @param blocks Batches held at once (at least 2)
+     */
+    explicit async_source(row_source &inner, size_t blocks = 2);
+    ~async_source();
+
+    async_source(const async_source &) = delete;
+    async_source &operator=(const async_source &) = delete;
+
+    size_t features() override { return nx; }
+    void rewind() override;
+    bool next(batch &out) override;
+    size_t peakBytes() override { return ringBytes + innerPeak; }
+    vector<string> featureNames() override { return names; }
+};
+
+#endif // HOMEMADESCIKIT_ROW_SOURCE_H
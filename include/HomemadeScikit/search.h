@@ -0,0 +1,75 @@
+#ifndef HOMEMADESCIKIT_SEARCH_H
+#define HOMEMADESCIKIT_SEARCH_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include "dataset.h"
+#include "model.h"
+
+using namespace std;
+
+/**
+ * @brief How cross_validate and grid_search split and schedule the work
+ *
+ * - `folds` contiguous folds (see kfold_split): every (candidate, fold)
+ *   pair trains one model on a view of the other folds and is scored on
+ *   the held-out one, so the dataset is never copied. Features and target
+ *   are those chosen on the dataset (chooseX / chooseY).
+ * - `threads` sizes the one pool that runs the pairs concurrently and,
+ *   nested in them, each model's data-parallel passes (0 = all cores).
+ *   The search sets the candidates' `pool`, `cancel`, `observer` and
+ *   `interval` itself.
+ * - `prune` cancels an iterative candidate on every fold once its cost
+ *   at a checked epoch is not finite, or more than `prune` times the
+ *   lowest cost any candidate had reached by that epoch on the same fold.
+ *   Epochs are checked every `interval`; 0 disables pruning. Which
+ *   candidates are cut can depend on scheduling; the costs of those that
+ *   finish do not.
+ */
+typedef struct search_settings
+{
+    size_t folds = 5;
+    int threads = 0;
+    double prune = 10;
+    int interval = 10;
+} search_settings;
+
+/** @brief One model trained on all folds but one */
+typedef struct fold_result
+{
+    train_report train;    // epochs, stop reason, training cost and seconds
+    double testCost = NAN; // cost on the held-out fold (NaN when cancelled)
+} fold_result;
+
+/** @brief Cross-validation of one set of model settings */
+typedef struct cv_report
+{
+    model_settings settings;
+    vector<fold_result> folds;
+    double meanCost = NAN;   // mean held-out cost (NaN when cancelled)
+    double stddevCost = NAN; // its spread over the folds
+    double seconds = 0;      // training time summed over the folds
+    bool cancelled = false;
+} cv_report;
+
+/** @brief Outcome of a grid search */
+typedef struct search_report
+{
+    vector<cv_report> candidates; // in the order given
+    size_t best = 0;              // lowest meanCost (candidates.size() if every one was cancelled)
+    size_t cancelled = 0;
+    double seconds = 0; // wall time of the search
+} search_report;
+
+/** @brief k-fold cross-validation of `m`, the folds trained concurrently */
+cv_report cross_validate(dataset &data, const model_settings &m, const search_settings &s = {});
+
+/** @brief Cross-validate every candidate, all (candidate, fold) pairs concurrently */
+search_report grid_search(dataset &data, const vector<model_settings> &candidates, const search_settings &s = {});
+
+/** @brief `base` with every combination of `steps` and `epochs`, steps varying fastest */
+vector<model_settings> parameter_grid(const model_settings &base, const vector<double> &steps,
+                                      const vector<int> &epochs);
+
+#endif // HOMEMADESCIKIT_SEARCH_H
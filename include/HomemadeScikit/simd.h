@@ -0,0 +1,72 @@
+#ifndef HOMEMADESCIKIT_SIMD_H
+#define HOMEMADESCIKIT_SIMD_H
+
+#include <cstddef>
+
+using namespace std;
+
+/** @brief Instruction sets the vector kernels are built for */
+enum class simd_isa
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512
+};
+
+/**
+ * @brief Table of vector kernels for one instruction set
+ *
+ * - dot(x, y, n)         sum of x[i] * y[i]
+ * - axpy(a, x, y, n)     y[i] += a * x[i]
+ * - affine(a, x, c, y, n) y[i] = a * x[i] + c
+ * - scale(a, x, n)       x[i] *= a
+ * - sum(x, n)            sum of x[i]
+ * - sum_squares(x, n)    sum of x[i] * x[i]
+ *
+ * and their single-precision counterparts on float arrays: the `_f`
+ * reductions accumulate in float (twice the lanes), the `_fd` ones
+ * widen each element and accumulate in double.
+ */
+typedef struct simd_kernels
+{
+    simd_isa isa;
+    double (*dot)(const double *x, const double *y, size_t n);
+    void (*axpy)(double a, const double *x, double *y, size_t n);
+    void (*affine)(double a, const double *x, double c, double *y, size_t n);
+    void (*scale)(double a, double *x, size_t n);
+    double (*sum)(const double *x, size_t n);
+    double (*sum_squares)(const double *x, size_t n);
+    float (*dot_f)(const float *x, const float *y, size_t n);
+    double (*dot_fd)(const float *x, const float *y, size_t n);
+    void (*axpy_f)(float a, const float *x, float *y, size_t n);
+    void (*affine_f)(float a, const float *x, float c, float *y, size_t n);
+    float (*sum_f)(const float *x, size_t n);
+    double (*sum_fd)(const float *x, size_t n);
+} simd_kernels;
+
+/**
+ * @brief The kernels in use
+ *
+ * Chosen on first use from CPUID (the widest supported set wins), unless
+ * the HS_SIMD environment variable (scalar, sse2, avx2, avx512) or
+ * simd_force() says otherwise.
+ */
+const simd_kernels &simd();
+
+/** @brief Best instruction set this CPU and build support */
+simd_isa simd_detect();
+
+/** @brief Whether kernels for `isa` are built in and runnable here */
+bool simd_supported(simd_isa isa);
+
+/**
+ * @brief Use the kernels of `isa` from now on (for testing every path)
+ * @return false, leaving the selection unchanged, if `isa` is unsupported
+ */
+bool simd_force(simd_isa isa);
+
+/** @brief Lower-case name of an instruction set ("avx2", ...) */
+const char *simd_name(simd_isa isa);
+
+#endif // HOMEMADESCIKIT_SIMD_H
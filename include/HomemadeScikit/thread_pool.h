@@ -0,0 +1,65 @@
+#ifndef HOMEMADESCIKIT_THREAD_POOL_H
+#define HOMEMADESCIKIT_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief A fixed set of worker threads with one task deque each.
+ *
+ * `run(count, fn)` calls fn(0) ... fn(count - 1) across the workers and
+ * returns once all of them have finished. The calling thread takes part in
+ * the work, so a pool of size 1 spawns no threads at all.
+ *
+ * A worker queues the helpers of its own run() calls on its own deque and
+ * takes work from the back of it; an idle worker steals from the front of
+ * the others'. So run() may be called from inside a task (a fold of a
+ * grid search running its data-parallel passes on the same pool): the
+ * inner helpers go to whichever workers are free, and a caller never
+ * blocks on a helper that nobody has started, it withdraws it instead.
+ */
+class thread_pool
+{
+private:
+    // a queued helper, tagged with the run() call it belongs to
+    typedef struct task
+    {
+        function<void()> work;
+        const void *owner;
+    } task;
+
+    vector<thread> workers;
+    vector<deque<task>> queues; // one per worker, then one for outside callers
+    mutex lock;
+    condition_variable wake;
+    bool stopping;
+
+    void workerLoop(size_t self);
+    bool take(size_t self, task &out);
+
+public:
+    /** @brief Create a pool running on `threads` threads (0 = all hardware threads) */
+    explicit thread_pool(size_t threads = 0);
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    /** @brief Number of threads that execute tasks, including the caller */
+    size_t size() const { return workers.size() + 1; }
+
+    /** @brief Run fn(i) for every i in [0, count) and wait for all of them */
+    void run(size_t count, const function<void(size_t)> &fn);
+
+    /** @brief Resolve a requested thread count (0 = all hardware threads) */
+    static size_t resolve(size_t threads);
+};
+
+#endif // HOMEMADESCIKIT_THREAD_POOL_H
@@ -3,20 +3,30 @@
 
 #include <vector>
 #include <string>
+#include "vector_expr.h"
 
 using namespace std;
 
-// Vector operations
+// Vector operations (the binary ones are lazy, see vector_expr.h)
 double dot(const vector<double> &v1, const vector<double> &v2);
 
-vector<double> operator/(const vector<double> &v, double n);
 vector<double> &operator/=(vector<double> &v, double n);
 vector<double> &operator-=(vector<double> &v1, const vector<double> &v2);
-vector<double> operator-(const vector<double> &v1, const vector<double> &v2);
-vector<double> operator*(const vector<double> &v, const double n);
-vector<double> operator*(const double n, const vector<double> &v);
 
 // String utilities
+
+/**
+ * @brief Parse a CSV cell without allocating or throwing
+ *
+ * Accepts what stod accepts (leading whitespace, a '+' sign, trailing
+ * garbage after a numeric prefix). Returns false for empty, malformed or
+ * out-of-range cells, which callers record as missing.
+ */
+bool parse_double(const char *first, const char *last, double &value);
+
+/** @brief Parse a "true" / "false" cell (any case, padded) as 1.0 / 0.0 */
+bool parse_bool(const char *first, const char *last, double &value);
+
 bool ends_with(string m, string s);
 
 int string_to_vector(vector<double> &v, const string &line, const string separator, int next);
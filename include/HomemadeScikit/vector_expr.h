@@ -0,0 +1,118 @@
+#ifndef HOMEMADESCIKIT_VECTOR_EXPR_H
+#define HOMEMADESCIKIT_VECTOR_EXPR_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief Lazily evaluated vector arithmetic
+ *
+ * `v * k`, `k * v`, `v / k` and `v1 - v2` build small expression objects
+ * instead of temporary vectors; the work happens in one fused loop when
+ * the expression is assigned or applied with `-=`. Expressions convert
+ * implicitly to `vector<double>`, so `vector<double> r = a - b * 2;` still
+ * works.
+ *
+ * Operands are held by reference: keep an expression alive only as long
+ * as the vectors it names (do not store one in an `auto` variable that
+ * outlives a temporary operand).
+ */
+template <typename E>
+struct vec_expr
+{
+    const E &self() const { return static_cast<const E &>(*this); }
+    size_t size() const { return self().size(); }
+    double operator[](size_t i) const { return self()[i]; }
+
+    /** @brief Evaluate into a new vector */
+    operator vector<double>() const
+    {
+        vector<double> result(size());
+        for (size_t i = 0; i < result.size(); i++)
+            result[i] = (*this)[i];
+        return result;
+    }
+};
+
+/** @brief Leaf: a reference to an existing vector */
+struct vec_ref : vec_expr<vec_ref>
+{
+    const double *p;
+    size_t n;
+
+    explicit vec_ref(const vector<double> &v) : p(v.data()), n(v.size()) {}
+    size_t size() const { return n; }
+    double operator[](size_t i) const { return p[i]; }
+};
+
+/** @brief e * k */
+template <typename E>
+struct vec_scale : vec_expr<vec_scale<E>>
+{
+    E e;
+    double k;
+
+    vec_scale(const E &e, double k) : e(e), k(k) {}
+    size_t size() const { return e.size(); }
+    double operator[](size_t i) const { return e[i] * k; }
+};
+
+/** @brief e / k */
+template <typename E>
+struct vec_div : vec_expr<vec_div<E>>
+{
+    E e;
+    double k;
+
+    vec_div(const E &e, double k) : e(e), k(k) {}
+    size_t size() const { return e.size(); }
+    double operator[](size_t i) const { return e[i] / k; }
+};
+
+/** @brief l - r */
+template <typename L, typename R>
+struct vec_sub : vec_expr<vec_sub<L, R>>
+{
+    L l;
+    R r;
+
+    vec_sub(const L &l, const R &r) : l(l), r(r) {}
+    size_t size() const { return l.size(); }
+    double operator[](size_t i) const { return l[i] - r[i]; }
+};
+
+inline vec_scale<vec_ref> operator*(const vector<double> &v, const double n) { return {vec_ref(v), n}; }
+inline vec_scale<vec_ref> operator*(const double n, const vector<double> &v) { return {vec_ref(v), n}; }
+template <typename E>
+vec_scale<E> operator*(const vec_expr<E> &e, const double n) { return {e.self(), n}; }
+template <typename E>
+vec_scale<E> operator*(const double n, const vec_expr<E> &e) { return {e.self(), n}; }
+
+inline vec_div<vec_ref> operator/(const vector<double> &v, double n) { return {vec_ref(v), n}; }
+template <typename E>
+vec_div<E> operator/(const vec_expr<E> &e, double n) { return {e.self(), n}; }
+
+inline vec_sub<vec_ref, vec_ref> operator-(const vector<double> &v1, const vector<double> &v2) { return {vec_ref(v1), vec_ref(v2)}; }
+template <typename E>
+vec_sub<vec_ref, E> operator-(const vector<double> &v, const vec_expr<E> &e) { return {vec_ref(v), e.self()}; }
+template <typename E>
+vec_sub<E, vec_ref> operator-(const vec_expr<E> &e, const vector<double> &v) { return {e.self(), vec_ref(v)}; }
+template <typename L, typename R>
+vec_sub<L, R> operator-(const vec_expr<L> &l, const vec_expr<R> &r) { return {l.self(), r.self()}; }
+
+/** @brief v -= expression, in one loop and without allocating */
+template <typename E>
+vector<double> &operator-=(vector<double> &v, const vec_expr<E> &e)
+{
+    const E &x = e.self();
+    for (size_t i = 0; i < v.size(); i++)
+        v[i] -= x[i];
+    return v;
+}
+
+/** @brief v -= k * u, the gradient step, runs as a vectorised axpy */
+vector<double> &operator-=(vector<double> &v, const vec_scale<vec_ref> &e);
+
+#endif // HOMEMADESCIKIT_VECTOR_EXPR_H
@@ -0,0 +1,90 @@
+/**
+ * @file column.cpp
+ * @brief One-pass column statistics.
+ */
+
+#include "HomemadeScikit/column.h"
+#include <algorithm>
+
+column_stats merge(const column_stats &a, const column_stats &b)
+{
+    if (a.count == 0 || b.count == 0)
+    {
+        column_stats out = a.count ? a : b;
+        out.nulls = a.nulls + b.nulls;
+        return out;
+    }
+
+    column_stats out;
+    out.count = a.count + b.count;
+    out.nulls = a.nulls + b.nulls;
+    out.min = min(a.min, b.min);
+    out.max = max(a.max, b.max);
+
+    double na = a.count, nb = b.count, n = out.count;
+    double delta = b.mean - a.mean;
+    out.mean = a.mean + delta * nb / n;
+    double m2 = a.variance * na + b.variance * nb + delta * delta * na * nb / n;
+    out.variance = m2 / n;
+    return out;
+}
+
+template <class T>
+static column_stats summarizeAny(const T *v, const uint64_t *bits, size_t n)
+{
+    const size_t block = 1024; // a multiple of 64, so blocks own whole bitmap words
+    column_stats total;
+
+    for (size_t begin = 0; begin < n; begin += block)
+    {
+        size_t end = min(n, begin + block);
+        column_stats part;
+        double sum = 0;
+        double lo = INFINITY, hi = -INFINITY;
+
+        auto isSet = [&](size_t i)
+        { return !bits || ((bits[i >> 6] >> (i & 63)) & 1); };
+
+        for (size_t i = begin; i < end; i++)
+        {
+            if (!isSet(i))
+            {
+                part.nulls++;
+                continue;
+            }
+            part.count++;
+            double x = v[i];
+            sum += x;
+            lo = min(lo, x);
+            hi = max(hi, x);
+        }
+
+        if (part.count)
+        {
+            // second sweep over the block while it is still in cache
+            double mean = sum / part.count;
+            double m2 = 0;
+            for (size_t i = begin; i < end; i++)
+            {
+                if (isSet(i))
+                    m2 += (v[i] - mean) * (v[i] - mean);
+            }
+            part.min = lo;
+            part.max = hi;
+            part.mean = mean;
+            part.variance = m2 / part.count;
+        }
+        total = merge(total, part);
+    }
+    return total;
+}
+
+column_stats summarize(const double *v, const uint64_t *bits, size_t n)
+{
+    return summarizeAny(v, bits, n);
+}
+
+column_stats summarize(const float *v, const uint64_t *bits, size_t n)
+{
+    return summarizeAny(v, bits, n);
+}
@@ -5,10 +5,176 @@
 
 #include "HomemadeScikit/dataset.h"
 #include "HomemadeScikit/utils.h"
-#include <fstream>
+#include "HomemadeScikit/mapped_file.h"
+#include "HomemadeScikit/thread_pool.h"
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <deque>
+#include <memory_resource>
+#include <unordered_map>
+
+// Binary columnar format (.hsd)
+static const char HSD_MAGIC[8] = {'H', 'S', 'D', 'A', 'T', 'A', '\0', '\0'};
+static const uint32_t HSD_VERSION = 2; // 2 added the column kinds and categories
+static const uint32_t HSD_ENDIAN = 0x01020304;
+static const size_t HSD_ALIGN = 64;
+
+struct hsd_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t columns;
+    uint64_t rows;
+};
+
+struct hsd_column
+{
+    uint64_t headerOffset; // into the string table
+    uint64_t headerLength;
+    uint64_t typeOffset;
+    uint64_t typeLength;
+    uint64_t valuesOffset; // from the start of the file
+    uint64_t validityOffset;
+    uint64_t nulls;
+    uint32_t kind;   // index into HSD_KINDS; was reserved (0) in version 1
+    uint32_t levels; // category levels, stored after the type as (uint32 length, bytes) pairs
+};
+
+static const char *const HSD_KINDS[] = {"double", "int", "bool", "category"};
+
+static uint64_t alignUp(uint64_t x)
+{
+    return (x + HSD_ALIGN - 1) / HSD_ALIGN * HSD_ALIGN;
+}
+
+/** Number of data lines in `body`; a final line without '\n' still counts */
+static size_t countLines(string_view body)
+{
+    if (body.empty())
+        return 0;
+    size_t count = 0;
+    const char *p = body.data();
+    const char *end = p + body.size();
+    while ((p = static_cast<const char *>(memchr(p, '\n', end - p))) != nullptr)
+    {
+        count++;
+        p++;
+    }
+    if (body.back() != '\n')
+        count++;
+    return count;
+}
+
+/**
+ * Data lines in `body` judged from the mean length of its first 64 KiB,
+ * with some headroom: the buffers sized from it are only reserved, so
+ * unused rows cost address space rather than memory
+ */
+static size_t estimateLines(string_view body)
+{
+    string_view sample = body.substr(0, 1 << 16);
+    size_t lines = countLines(sample);
+    if (lines == 0 || sample.size() == body.size())
+        return lines;
+    double estimate = double(body.size()) * lines / sample.size();
+    return size_t(estimate * 1.125) + 64;
+}
+
+/** `[first, last)` without its surrounding whitespace */
+static string_view trim(const char *first, const char *last)
+{
+    while (first < last && (*first == ' ' || (*first >= '\t' && *first <= '\r')))
+        first++;
+    while (last > first && (last[-1] == ' ' || (last[-1] >= '\t' && last[-1] <= '\r')))
+        last--;
+    return string_view(first, last - first);
+}
+
+/**
+ * The kind of each of `n` columns, judged from the first `sample` lines
+ * of `body`: "category" when most non-empty cells are not numbers, else
+ * "bool", "int" or "double" (see load_settings)
+ */
+static vector<string> inferKinds(string_view body, int n, size_t sample)
+{
+    vector<size_t> filled(n), text(n), numbers(n), integral(n), binary(n), words(n);
+    const char *p = body.data();
+    const char *end = p + body.size();
+    for (size_t line = 0; line < sample && p < end; line++)
+    {
+        const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+        const char *lineEnd = nl ? nl : end;
+        for (int i = 0; i < n; i++)
+        {
+            const char *comma = static_cast<const char *>(memchr(p, ',', lineEnd - p));
+            const char *fieldEnd = comma ? comma : lineEnd;
+            string_view cell = trim(p, fieldEnd);
+            double value;
+            if (!cell.empty())
+            {
+                filled[i]++;
+                if (parse_double(cell.data(), cell.data() + cell.size(), value))
+                {
+                    numbers[i]++;
+                    integral[i] += isfinite(value) && value == trunc(value);
+                    binary[i] += value == 0.0 || value == 1.0;
+                }
+                else if (parse_bool(cell.data(), cell.data() + cell.size(), value))
+                    words[i]++;
+                else
+                    text[i]++;
+            }
+            if (!comma)
+                break;
+            p = comma + 1;
+        }
+        p = lineEnd + 1;
+    }
+
+    vector<string> kinds(n, "double");
+    for (int i = 0; i < n; i++)
+    {
+        if (2 * text[i] > filled[i])
+            kinds[i] = "category";
+        else if (filled[i] > text[i] && binary[i] + words[i] == filled[i] - text[i])
+            kinds[i] = "bool";
+        else if (numbers[i] > 0 && integral[i] == numbers[i])
+            kinds[i] = "int";
+    }
+    return kinds;
+}
+
+// the missing-cell lists and category dictionaries of one chunk, carved
+// from its own arena; level texts are views into the mapped file
+struct dataset::chunk_arena
+{
+    pmr::monotonic_buffer_resource arena{1 << 16};
+    pmr::vector<pmr::deque<size_t>> missing{&arena};
+    pmr::vector<pmr::unordered_map<string_view, uint32_t>> codes{&arena};
+    pmr::vector<pmr::vector<string_view>> levels{&arena}; // per column, in code order
+
+    explicit chunk_arena(int n)
+    {
+        missing.resize(n);
+        codes.resize(n);
+        levels.resize(n);
+    }
+
+    /** The chunk's code for level `text` of column `i`, numbered by first appearance */
+    uint32_t code(int i, string_view text)
+    {
+        auto found = codes[i].try_emplace(text, uint32_t(levels[i].size()));
+        if (found.second)
+            levels[i].push_back(text);
+        return found.first->second;
+    }
+};
 
 dataset::dataset()
 {
@@ -18,10 +184,12 @@ dataset::dataset()
     data = {};
 }
 
-dataset::dataset(string s) : dataset()
+dataset::dataset(string s, const load_settings &options) : dataset()
 {
     if (ends_with(s, ".csv"))
-        load_csv(s);
+        load_csv(s, options);
+    else if (ends_with(s, ".hsd"))
+        load_binary(s);
     else
         throw runtime_error("Dataset initialization: File type not supported\n");
 }
@@ -31,7 +199,7 @@ vector<double> dataset::getRow(int index)
     vector<double> result = {};
     for (const int i : settings.x)
     {
-        result.push_back(data[i].data[index].first);
+        result.push_back(data[i].value(index));
     }
     reverse(result.begin(), result.end());
     return result;
@@ -48,151 +216,418 @@ int dataset::getIndex(string x)
     return -1;
 }
 
-int dataset::loadHeaders(string line)
+int dataset::loadHeaders(string_view line)
 {
-    int count = 0;
-
-    column temp;
-    temp.type = "double";
-    temp.data = vector<pair<double, bool>>();
+    int count = line.empty() ? 0 : 1 + int(std::count(line.begin(), line.end(), ','));
+    if (!line.empty() && line.back() == ',')
+        count--;
+    data.reserve(count);
 
     size_t start = 0;
-    size_t end = line.find(',');
-
-    while (end != string::npos)
+    for (int i = 0; i < count; i++)
     {
-        temp.header = line.substr(start, end - start);
-        data.push_back(temp);
-
+        size_t end = min(line.find(',', start), line.size());
+        column &c = data.emplace_back();
+        c.header = line.substr(start, end - start);
+        c.type = "double";
         start = end + 1;
-        end = line.find(',', start);
-        count++;
-    }
-
-    if (start < line.length())
-    {
-        temp.header = line.substr(start);
-        data.push_back(temp);
-        count++;
     }
 
     return count;
 }
 
-int dataset::loadLine(string line, int n)
+int dataset::loadLine(string_view line, size_t row, int n, double *const *cells, uint32_t *const *codes,
+                      chunk_arena &chunk)
 {
-    pair<double, bool> temp;
+    pmr::vector<pmr::deque<size_t>> &missing = chunk.missing;
     int i = 0;
+    double value;
 
-    vector<pair<double, bool>> a(n, {0.0, false});
-
-    size_t start = 0;
-    size_t end = line.find(',');
+    const char *p = line.data();
+    const char *stop = p + line.size();
 
-    while (end != string::npos && i < n)
+    while (i < n)
     {
-        size_t len = end - start;
-        if (len == 0)
+        const char *comma = static_cast<const char *>(memchr(p, ',', stop - p));
+        const char *fieldEnd = comma ? comma : stop;
+
+        column &c = data[i];
+        if (c.isCategory())
         {
-            temp.second = false;
-            temp.first = 0.0;
+            string_view text = trim(p, fieldEnd);
+            if (!text.empty())
+                codes[i][row] = chunk.code(i, text);
+            else
+                missing[i].push_back(row);
         }
+        else if (parse_double(p, fieldEnd, value) || (c.kind == "bool" && parse_bool(p, fieldEnd, value)))
+            cells[i][row] = value;
         else
+            missing[i].push_back(row);
+        i++;
+
+        if (!comma)
+            break;
+        p = comma + 1;
+    }
+
+    for (; i < n; i++)
+    {
+        missing[i].push_back(row);
+    }
+
+    return 0;
+}
+
+void dataset::load_csv(string filename, const load_settings &options)
+{
+    string cache = filename + ".hsd";
+    if (options.cache)
+    {
+        error_code ec;
+        if (filesystem::exists(cache, ec) &&
+            filesystem::last_write_time(cache, ec) >= filesystem::last_write_time(filename, ec) && !ec)
         {
-            string token = line.substr(start, len);
             try
             {
-                temp.first = stod(token);
-                temp.second = true;
+                load_binary(cache);
+                bool matches = true;
+                for (const column &c : data)
+                    matches = matches && (c.isCategory() ? options.infer : c.type == options.precision) &&
+                              (options.infer || c.kind == "double");
+                if (matches)
+                    return;
+                // built at the other precision or typing: rebuild it from the CSV
             }
-            catch (const std::invalid_argument &)
+            catch (const runtime_error &)
             {
-                temp.second = false;
-                temp.first = 0.0;
-            }
-            catch (const std::out_of_range &)
-            {
-                temp.second = false;
-                temp.first = 0.0;
+                // stale or foreign cache: fall through and rebuild it
             }
         }
-        a[i] = temp;
-        start = end + 1;
-        end = line.find(',', start);
-        i++;
     }
 
-    if (i < n)
+    mapped_file file(filename);
+    string_view text = file.view();
+
+    if (text.empty())
+        throw runtime_error("Empty or invalid CSV file: " + filename);
+
+    size_t eol = text.find('\n');
+    string_view header = text.substr(0, eol);
+    string_view body = (eol == string_view::npos) ? string_view() : text.substr(eol + 1);
+
+    data.clear();
+
+    int n = loadHeaders(header);
+
+    // cut the body into newline-aligned chunks, a few per worker so that
+    // uneven line lengths still balance out
+    thread_pool pool(options.threads < 0 ? 1 : options.threads);
+    size_t wanted = pool.size() == 1 ? 1 : pool.size() * 4;
+    size_t target = body.size() / wanted + 1;
+
+    vector<string_view> chunks;
+    size_t pos = 0;
+    while (pos < body.size())
     {
-        size_t len = (start < line.length()) ? (line.length() - start) : 0;
-        if (len == 0)
+        size_t cut = min(pos + target, body.size());
+        if (cut < body.size())
         {
-            temp.second = false;
-            temp.first = 0.0;
+            const char *nl = static_cast<const char *>(memchr(body.data() + cut, '\n', body.size() - cut));
+            cut = nl ? (nl - body.data()) + 1 : body.size();
         }
+        chunks.push_back(body.substr(pos, cut - pos));
+        pos = cut;
+    }
+
+    // pass 1: rows per chunk, turned into each chunk's first row. A lone
+    // chunk skips it: its buffers are sized from an estimate instead
+    vector<size_t> firstRow(chunks.size() + 1, 0);
+    if (chunks.size() > 1)
+    {
+        pool.run(chunks.size(), [&](size_t c)
+                 { firstRow[c + 1] = countLines(chunks[c]); });
+        for (size_t c = 0; c < chunks.size(); c++)
+            firstRow[c + 1] += firstRow[c];
+    }
+    else if (!chunks.empty())
+        firstRow[1] = estimateLines(body);
+    size_t capacity = firstRow[chunks.size()];
+
+    vector<string> kinds = options.infer ? inferKinds(body, n, options.sample) : vector<string>(n, "double");
+    for (int i = 0; i < n; i++)
+    {
+        if (kinds[i] == "category")
+            data[i].assignCodes(capacity);
         else
+            data[i].assign(capacity);
+        data[i].kind = kinds[i];
+    }
+
+    // missing cells are listed in per-chunk arenas, released all at once
+    // when the load returns
+    deque<chunk_arena> arenas;
+    for (size_t c = 0; c < chunks.size(); c++)
+        arenas.emplace_back(n);
+
+    // the buffers are written through pointers taken once: mutableData()
+    // updates the column itself, which the workers must not do concurrently
+    vector<double *> cells(n);
+    vector<uint32_t *> codes(n);
+    auto bind = [&]()
+    {
+        for (int i = 0; i < n; i++)
         {
-            string token = line.substr(start, len);
-            try
+            cells[i] = data[i].isCategory() ? nullptr : data[i].mutableData();
+            codes[i] = data[i].isCategory() ? data[i].mutableCodes() : nullptr;
+        }
+    };
+    bind();
+
+    // pass 2: every chunk parses into its own row range of the shared buffers
+    size_t linesRead = 0;
+    pool.run(chunks.size(), [&](size_t c)
+             {
+        size_t row = firstRow[c];
+        const char *p = chunks[c].data();
+        const char *end = p + chunks[c].size();
+        while (p < end)
+        {
+            // only a lone chunk can outgrow its estimate
+            if (row == capacity)
             {
-                temp.first = stod(token);
-                temp.second = true;
+                capacity += capacity / 2 + 64;
+                for (column &col : data)
+                    col.resize(capacity);
+                bind();
             }
-            catch (const std::invalid_argument &)
+            const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+            const char *lineEnd = nl ? nl : end;
+            if (loadLine(string_view(p, lineEnd - p), row, n, cells.data(), codes.data(), arenas[c]) != 0)
+                throw runtime_error("ERROR in line");
+            row++;
+            p = lineEnd + 1;
+        }
+        if (c + 1 == chunks.size())
+            linesRead = row; });
+
+    if (linesRead != capacity)
+        for (column &c : data)
+            c.resize(linesRead);
+
+    // stitch: only the missing cells remain to be flagged
+    for (const chunk_arena &chunk : arenas)
+        for (int i = 0; i < n; i++)
+            for (size_t row : chunk.missing[i])
+                data[i].setMissing(row);
+
+    // merge the chunk dictionaries in chunk order, so levels are numbered
+    // by first appearance in the file, and renumber the later chunks' codes
+    firstRow[chunks.size()] = linesRead;
+    vector<vector<uint32_t>> remap(chunks.size());
+    for (int i = 0; i < n; i++)
+    {
+        if (!data[i].isCategory())
+            continue;
+        shared_ptr<vector<string>> levels = make_shared<vector<string>>();
+        unordered_map<string_view, uint32_t> merged;
+        bool renumber = false;
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            const pmr::vector<string_view> &local = arenas[c].levels[i];
+            remap[c].resize(local.size());
+            for (size_t k = 0; k < local.size(); k++)
             {
-                temp.second = false;
-                temp.first = 0.0;
+                auto found = merged.try_emplace(local[k], uint32_t(levels->size()));
+                if (found.second)
+                    levels->emplace_back(local[k]);
+                remap[c][k] = found.first->second;
+                renumber = renumber || remap[c][k] != k;
             }
-            catch (const std::out_of_range &)
+        }
+        data[i].setLevels(levels);
+        if (!renumber)
+            continue;
+
+        uint32_t *code = data[i].mutableCodes();
+        pool.run(chunks.size(), [&](size_t c)
+                 {
+            for (size_t row = firstRow[c]; row < firstRow[c + 1]; row++)
+                if (code[row] != NO_LEVEL)
+                    code[row] = remap[c][code[row]]; });
+    }
+
+    if (options.precision != "double")
+        setPrecision(options.precision);
+
+    loaded = true;
+    cout << "Brief: " << linesRead << " lines read, " << n << " Headers, " << n * linesRead << " Entries" << endl;
+
+    if (options.cache)
+        save_binary(cache);
+}
+
+void dataset::save_binary(string filename)
+{
+    uint64_t r = rows();
+    uint64_t c = cols();
+    uint64_t words = (r + 63) / 64;
+
+    // string table: headers and types back to back
+    string strings;
+    vector<hsd_column> directory(c);
+    for (uint64_t i = 0; i < c; i++)
+    {
+        directory[i] = {};
+        directory[i].headerOffset = strings.size();
+        directory[i].headerLength = data[i].header.size();
+        strings += data[i].header;
+        directory[i].typeOffset = strings.size();
+        directory[i].typeLength = data[i].type.size();
+        strings += data[i].type;
+        directory[i].nulls = data[i].nullCount();
+        for (uint32_t k = 0; k < std::size(HSD_KINDS); k++)
+            if (data[i].kind == HSD_KINDS[k])
+                directory[i].kind = k;
+        if (data[i].isCategory())
+        {
+            directory[i].levels = data[i].levels()->size();
+            for (const string &level : *data[i].levels())
             {
-                temp.second = false;
-                temp.first = 0.0;
+                uint32_t length = level.size();
+                strings.append(reinterpret_cast<const char *>(&length), sizeof(length));
+                strings += level;
             }
         }
-        a[i] = temp;
-        i++;
     }
 
-    if (i > n)
-        return -1;
-
-    for (; i < n; i++)
+    uint64_t offset = alignUp(sizeof(hsd_header) + c * sizeof(hsd_column) + strings.size());
+    for (uint64_t i = 0; i < c; i++)
     {
-        a[i].second = false;
-        a[i].first = 0.0;
+        directory[i].valuesOffset = offset;
+        size_t width = data[i].isFloat() ? sizeof(float) : data[i].isCategory() ? sizeof(uint32_t) : sizeof(double);
+        offset = alignUp(offset + r * width);
+        directory[i].validityOffset = offset;
+        offset = alignUp(offset + words * sizeof(uint64_t));
     }
 
-    for (int j = 0; j < n; ++j)
+    ofstream out(filename, ios::binary | ios::trunc);
+    if (!out.is_open())
+        throw runtime_error("Cannot open file: " + filename);
+
+    hsd_header h = {};
+    memcpy(h.magic, HSD_MAGIC, sizeof(h.magic));
+    h.version = HSD_VERSION;
+    h.endian = HSD_ENDIAN;
+    h.columns = c;
+    h.rows = r;
+
+    const char zeros[HSD_ALIGN] = {};
+    uint64_t written = 0;
+    auto put = [&](const void *p, uint64_t len)
     {
-        data[j].data.push_back(a[j]);
+        out.write(static_cast<const char *>(p), len);
+        written += len;
+    };
+    auto pad = [&]()
+    { put(zeros, alignUp(written) - written); };
+
+    put(&h, sizeof(h));
+    put(directory.data(), c * sizeof(hsd_column));
+    put(strings.data(), strings.size());
+    pad();
+    for (uint64_t i = 0; i < c; i++)
+    {
+        if (data[i].isFloat())
+            put(data[i].floatData(), r * sizeof(float));
+        else if (data[i].isCategory())
+            put(data[i].codeData(), r * sizeof(uint32_t));
+        else
+            put(data[i].data(), r * sizeof(double));
+        pad();
+        put(data[i].validityBits(), words * sizeof(uint64_t));
+        pad();
     }
 
-    return 0;
+    if (!out)
+        throw runtime_error("Cannot write file: " + filename);
 }
 
-void dataset::load_csv(string filename)
+void dataset::load_binary(string filename)
 {
-    ifstream iFile(filename);
-    if (!iFile.is_open())
-        throw runtime_error("Cannot open file: " + filename);
-
-    string line;
-    if (!getline(iFile, line))
-        throw runtime_error("Empty or invalid CSV file: " + filename);
+    shared_ptr<mapped_file> file = make_shared<mapped_file>(filename);
+    const char *base = file->data();
+    uint64_t size = file->size();
+
+    hsd_header h;
+    if (size < sizeof(h))
+        throw runtime_error("Invalid binary dataset: " + filename);
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, HSD_MAGIC, sizeof(h.magic)) != 0)
+        throw runtime_error("Invalid binary dataset: " + filename);
+    if (h.version < 1 || h.version > HSD_VERSION)
+        throw runtime_error("Unsupported binary dataset version " + to_string(h.version) + ": " + filename);
+    if (h.endian != HSD_ENDIAN)
+        throw runtime_error("Binary dataset has foreign byte order: " + filename);
+
+    uint64_t words = (h.rows + 63) / 64;
+    uint64_t stringsOffset = sizeof(hsd_header) + h.columns * sizeof(hsd_column);
+    if (h.columns > size / sizeof(hsd_column) || stringsOffset > size)
+        throw runtime_error("Truncated binary dataset: " + filename);
+
+    const hsd_column *directory = reinterpret_cast<const hsd_column *>(base + sizeof(hsd_header));
+    const char *strings = base + stringsOffset;
 
     data.clear();
-
-    int n = loadHeaders(line);
-    int linesRead = 0;
-
-    while (getline(iFile, line))
+    data.resize(h.columns);
+    for (uint64_t i = 0; i < h.columns; i++)
     {
-        if (loadLine(line, n) != 0)
-            throw runtime_error("ERROR in line");
-        linesRead++;
+        const hsd_column &e = directory[i];
+        if (stringsOffset + e.typeOffset + e.typeLength > size)
+            throw runtime_error("Truncated binary dataset: " + filename);
+        string type(strings + e.typeOffset, e.typeLength);
+        if (type != "double" && type != "float" && type != "category")
+            throw runtime_error("Unsupported column type " + type + ": " + filename);
+        if (e.kind >= std::size(HSD_KINDS))
+            throw runtime_error("Unsupported column kind " + to_string(e.kind) + ": " + filename);
+        size_t width = (type == "float") ? sizeof(float) : (type == "category") ? sizeof(uint32_t) : sizeof(double);
+
+        if (stringsOffset + e.headerOffset + e.headerLength > size ||
+            e.valuesOffset + h.rows * width > size ||
+            e.validityOffset + words * sizeof(uint64_t) > size)
+            throw runtime_error("Truncated binary dataset: " + filename);
+
+        data[i].header.assign(strings + e.headerOffset, e.headerLength);
+        const uint64_t *bits = reinterpret_cast<const uint64_t *>(base + e.validityOffset);
+        if (type == "category")
+        {
+            // the levels follow the type in the string table
+            shared_ptr<vector<string>> levels = make_shared<vector<string>>();
+            uint64_t at = stringsOffset + e.typeOffset + e.typeLength;
+            for (uint32_t k = 0; k < e.levels; k++)
+            {
+                uint32_t length;
+                if (at + sizeof(length) > size)
+                    throw runtime_error("Truncated binary dataset: " + filename);
+                memcpy(&length, base + at, sizeof(length));
+                at += sizeof(length);
+                if (at + length > size)
+                    throw runtime_error("Truncated binary dataset: " + filename);
+                levels->emplace_back(base + at, length);
+                at += length;
+            }
+            data[i].borrow(reinterpret_cast<const uint32_t *>(base + e.valuesOffset), bits, h.rows, e.nulls, levels,
+                           file);
+        }
+        else if (type == "float")
+            data[i].borrow(reinterpret_cast<const float *>(base + e.valuesOffset), bits, h.rows, e.nulls, file);
+        else
+            data[i].borrow(reinterpret_cast<const double *>(base + e.valuesOffset), bits, h.rows, e.nulls, file);
+        data[i].kind = HSD_KINDS[e.kind];
     }
+
     loaded = true;
-    cout << "Brief: " << linesRead << " lines read, " << n << " Headers, " << n * linesRead << " Entries" << endl;
+    cout << "Brief: " << h.rows << " lines read, " << h.columns << " Headers, " << h.rows * h.columns << " Entries (binary)" << endl;
 }
 
 int dataset::cols()
@@ -204,17 +639,19 @@ int dataset::rows()
 {
     if (data.empty())
         return 0;
-    return data[0].data.size();
+    return data[0].size();
 }
 
 string dataset::getValue(int row, int col)
 {
     if (col < 0 || col >= cols() || row < 0 || row >= rows())
         return "";
-    auto &p = data[col].data[row];
-    if (!p.second)
+    const column &c = data[col];
+    if (!c.isSet(row))
         return "x";
-    return to_string(p.first);
+    if (c.isCategory())
+        return (*c.levels())[c.codeData()[row]];
+    return to_string(c.value(row));
 }
 
 void dataset::print()
@@ -289,3 +726,31 @@ dataset &dataset::chooseX(const vector<variant<string, int>> &values)
     }
     return *this;
 }
+
+const column_stats &dataset::stats(int i)
+{
+    if (i < 0 || i >= (int)data.size())
+        throw out_of_range("stats: no column " + to_string(i));
+    return data[i].stats();
+}
+
+const column_stats &dataset::stats(string header)
+{
+    int i = getIndex(header);
+    if (i < 0)
+        throw out_of_range("stats: no column named " + header);
+    return data[i].stats();
+}
+
+void dataset::setPrecision(string precision)
+{
+    if (precision != "double" && precision != "float")
+        throw runtime_error("setPrecision: unknown precision " + precision);
+    for (column &c : data)
+    {
+        if (precision == "float")
+            c.narrow();
+        else
+            c.widen();
+    }
+}
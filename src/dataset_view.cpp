@@ -0,0 +1,241 @@
+/**
+ * @file dataset_view.cpp
+ * @brief Row subsets of a dataset that share its column buffers.
+ */
+
+#include "HomemadeScikit/dataset_view.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+dataset_view::dataset_view(dataset &p, size_t chunk)
+    : dataset_view(p, 0, p.rows(), chunk)
+{
+}
+
+dataset_view::dataset_view(dataset &p, size_t begin, size_t end, size_t chunk)
+    : dataset_view(p, vector<pair<size_t, size_t>>{{begin, end}}, chunk)
+{
+}
+
+dataset_view::dataset_view(dataset &p, vector<pair<size_t, size_t>> r, size_t chunk)
+    : parent(&p), ranges(move(r)), chunkRows(max<size_t>(chunk, 1)), settings(p.settings)
+{
+    for (const pair<size_t, size_t> &range : ranges)
+    {
+        if (range.first > range.second)
+            throw out_of_range("dataset_view: range ends before it begins");
+        check(range.second);
+        total += range.second - range.first;
+    }
+}
+
+dataset_view::dataset_view(dataset &p, vector<size_t> rows, size_t chunk)
+    : parent(&p), chunkRows(max<size_t>(chunk, 1)), settings(p.settings)
+{
+    for (size_t r : rows)
+        check(r + 1);
+    total = rows.size();
+    index = make_shared<const vector<size_t>>(move(rows));
+}
+
+void dataset_view::check(size_t rows)
+{
+    if (rows > size_t(parent->rows()))
+        throw out_of_range("dataset_view: row " + to_string(rows - 1) + " is past the end of the dataset");
+}
+
+bool dataset_view::zeroCopy()
+{
+    if (index)
+        return false;
+    for (int i : settings.x)
+        if (parent->data[i].isFloat())
+            return false;
+    return settings.y < 0 || !parent->data[settings.y].isFloat();
+}
+
+size_t dataset_view::parentRow(size_t i)
+{
+    if (i >= total)
+        throw out_of_range("dataset_view: no row " + to_string(i));
+    if (index)
+        return (*index)[i];
+    for (const pair<size_t, size_t> &range : ranges)
+    {
+        if (i < range.second - range.first)
+            return range.first + i;
+        i -= range.second - range.first;
+    }
+    return 0; // unreachable: i < total
+}
+
+vector<double> dataset_view::getRow(size_t i)
+{
+    size_t r = parentRow(i);
+    vector<double> result;
+    for (auto it = settings.x.rbegin(); it != settings.x.rend(); ++it)
+        result.push_back(parent->data[*it].value(r));
+    return result;
+}
+
+dataset_view &dataset_view::chooseX(const vector<variant<string, int>> &values)
+{
+    for (const variant<string, int> &v : values)
+    {
+        const int *ip = get_if<int>(&v);
+        int i = ip ? *ip : parent->getIndex(std::get<string>(v));
+        if (i == settings.y || i >= parent->cols() || i < 0)
+            continue;
+        settings.x.push_back(i);
+    }
+    return *this;
+}
+
+dataset_view &dataset_view::chooseY(variant<string, int> v)
+{
+    const int *ip = get_if<int>(&v);
+    int i = ip ? *ip : parent->getIndex(std::get<string>(v));
+    if (i < 0 || i >= parent->cols())
+    {
+        settings.y = -1;
+        return *this;
+    }
+    auto found = find(settings.x.begin(), settings.x.end(), i);
+    if (found != settings.x.end())
+        settings.x.erase(found);
+    settings.y = i;
+    return *this;
+}
+
+vector<string> dataset_view::featureNames()
+{
+    vector<string> names;
+    for (auto it = settings.x.rbegin(); it != settings.x.rend(); ++it)
+        names.push_back(parent->data[*it].header);
+    return names;
+}
+
+void dataset_view::rewind()
+{
+    piece = 0;
+    offset = 0;
+}
+
+bool dataset_view::next(batch &out)
+{
+    // weights follow dataset::getRow, which lists features in reverse
+    chosen.assign(settings.x.rbegin(), settings.x.rend());
+    size_t d = chosen.size();
+    if (settings.y >= 0)
+        chosen.push_back(settings.y);
+    // batches carry numbers only; category codes would read as magnitudes
+    for (int i : chosen)
+        if (parent->data[i].isCategory())
+            throw runtime_error("dataset_view: " + parent->data[i].header + " is a category column, train on the dataset");
+
+    if (zeroCopy())
+    {
+        while (piece < ranges.size() && ranges[piece].first == ranges[piece].second)
+            piece++;
+        if (piece == ranges.size())
+            return false;
+        size_t begin = ranges[piece++].first;
+        out.rows = ranges[piece - 1].second - begin;
+        out.x.resize(d);
+        for (size_t j = 0; j < d; j++)
+            out.x[j] = parent->data[chosen[j]].data() + begin;
+        out.y = settings.y >= 0 ? parent->data[settings.y].data() + begin : nullptr;
+        return true;
+    }
+
+    if (gathered.size() != chosen.size())
+    {
+        gathered.assign(chosen.size(), vector<double>(chunkRows));
+        peak = max(peak, chosen.size() * chunkRows * sizeof(double));
+    }
+
+    // copy (widening float columns) a stretch of consecutive view rows
+    auto gather = [&](size_t m, size_t n, const size_t *rows, size_t begin)
+    {
+        for (size_t c = 0; c < chosen.size(); c++)
+        {
+            const column &col = parent->data[chosen[c]];
+            double *dst = gathered[c].data() + m;
+            for (size_t t = 0; t < n; t++)
+                dst[t] = col.value(rows ? rows[t] : begin + t);
+        }
+    };
+
+    size_t m = 0;
+    while (m < chunkRows)
+    {
+        if (index)
+        {
+            if (piece >= index->size())
+                break;
+            size_t n = min(chunkRows - m, index->size() - piece);
+            gather(m, n, index->data() + piece, 0);
+            piece += n;
+            m += n;
+        }
+        else
+        {
+            if (piece >= ranges.size())
+                break;
+            size_t begin = ranges[piece].first + offset;
+            size_t n = min(chunkRows - m, ranges[piece].second - begin);
+            gather(m, n, nullptr, begin);
+            m += n;
+            offset += n;
+            if (ranges[piece].first + offset >= ranges[piece].second)
+            {
+                piece++;
+                offset = 0;
+            }
+        }
+    }
+    if (m == 0)
+        return false;
+
+    out.rows = m;
+    out.x.resize(d);
+    for (size_t j = 0; j < d; j++)
+        out.x[j] = gathered[j].data();
+    out.y = settings.y >= 0 ? gathered[d].data() : nullptr;
+    return true;
+}
+
+pair<dataset_view, dataset_view> kfold_split(dataset &data, size_t k, size_t fold)
+{
+    if (k < 2 || fold >= k)
+        throw out_of_range("kfold_split: fold " + to_string(fold) + " of " + to_string(k));
+    size_t n = data.rows();
+    size_t begin = n * fold / k;
+    size_t end = n * (fold + 1) / k;
+    return {dataset_view(data, {{0, begin}, {end, n}}), dataset_view(data, begin, end)};
+}
+
+pair<dataset_view, dataset_view> train_test_split(dataset &data, double testFraction)
+{
+    if (!(testFraction >= 0 && testFraction <= 1))
+        throw out_of_range("train_test_split: the test fraction must be in [0, 1]");
+    size_t n = data.rows();
+    size_t cut = n - size_t(n * testFraction + 0.5);
+    return {dataset_view(data, 0, cut), dataset_view(data, cut, n)};
+}
+
+pair<dataset_view, dataset_view> train_test_split(dataset &data, double testFraction, unsigned seed)
+{
+    if (!(testFraction >= 0 && testFraction <= 1))
+        throw out_of_range("train_test_split: the test fraction must be in [0, 1]");
+    size_t n = data.rows();
+    size_t cut = n - size_t(n * testFraction + 0.5);
+    vector<size_t> order(n);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), mt19937_64(seed));
+    vector<size_t> test(order.begin() + cut, order.end());
+    order.resize(cut);
+    return {dataset_view(data, move(order)), dataset_view(data, move(test))};
+}
@@ -0,0 +1,18 @@
+/**
+ * @file fixed_model.cpp
+ * @brief Runtime dispatch to the fixed-width kernels.
+ */
+
+#include "HomemadeScikit/fixed_model.h"
+
+template <size_t... I>
+static const fixed_kernels *fixedTable(size_t d, index_sequence<I...>)
+{
+    static const fixed_kernels *const tables[] = {&fixed_kernel<I + 1>::table...};
+    return d >= 1 && d <= sizeof...(I) ? tables[d - 1] : nullptr;
+}
+
+const fixed_kernels *fixed_kernels_for(size_t d)
+{
+    return fixedTable(d, make_index_sequence<FIXED_MAX_FEATURES>());
+}
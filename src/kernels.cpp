@@ -0,0 +1,133 @@
+/**
+ * @file kernels.cpp
+ * @brief Fused training kernels.
+ */
+
+#include "HomemadeScikit/kernels.h"
+#include "HomemadeScikit/simd.h"
+#include <algorithm>
+#include <type_traits>
+
+// rows per block: 1024 residuals (8 KiB) stay resident in L1
+static const size_t BLOCK = 1024;
+
+// picks the kernel of the table for the element type; `wide` selects
+// double accumulation for float reductions
+template <class T>
+struct lanes;
+
+template <>
+struct lanes<double>
+{
+    static void affine(const simd_kernels &k, double a, const double *x, double c, double *y, size_t n) { k.affine(a, x, c, y, n); }
+    static void axpy(const simd_kernels &k, double a, const double *x, double *y, size_t n) { k.axpy(a, x, y, n); }
+    static double dot(const simd_kernels &k, const double *x, const double *y, size_t n, bool) { return k.dot(x, y, n); }
+    static double sum(const simd_kernels &k, const double *x, size_t n, bool) { return k.sum(x, n); }
+};
+
+template <>
+struct lanes<float>
+{
+    static void affine(const simd_kernels &k, float a, const float *x, float c, float *y, size_t n) { k.affine_f(a, x, c, y, n); }
+    static void axpy(const simd_kernels &k, float a, const float *x, float *y, size_t n) { k.axpy_f(a, x, y, n); }
+    static double dot(const simd_kernels &k, const float *x, const float *y, size_t n, bool wide) { return wide ? k.dot_fd(x, y, n) : k.dot_f(x, y, n); }
+    static double sum(const simd_kernels &k, const float *x, size_t n, bool wide) { return wide ? k.sum_fd(x, n) : k.sum_f(x, n); }
+};
+
+template <class T>
+static void fusedGradient(const basic_batch<T> &rows, const T *w, T b, double *gw, double &gb, double &cost, bool wide)
+{
+    T r[BLOCK];
+    size_t d = rows.x.size();
+    const simd_kernels &k = simd();
+
+    for (size_t start = 0; start < rows.rows; start += BLOCK)
+    {
+        size_t m = min(BLOCK, rows.rows - start);
+
+        lanes<T>::affine(k, -1, rows.y + start, b, r, m);
+        for (size_t j = 0; j < d; j++)
+            lanes<T>::axpy(k, w[j], rows.x[j] + start, r, m);
+
+        if (gw)
+        {
+            for (size_t j = 0; j < d; j++)
+                gw[j] += lanes<T>::dot(k, rows.x[j] + start, r, m, wide);
+        }
+
+        gb += lanes<T>::sum(k, r, m, wide);
+        cost += lanes<T>::dot(k, r, r, m, wide);
+    }
+}
+
+void fused_gradient(const batch &rows, const double *w, double b, double *gw, double &gb, double &cost)
+{
+    fusedGradient(rows, w, b, gw, gb, cost, true);
+}
+
+void fused_gradient(const batch_f &rows, const float *w, float b, double *gw, double &gb, double &cost, bool wide)
+{
+    fusedGradient(rows, w, b, gw, gb, cost, wide);
+}
+
+template <class T>
+static void predictColumns(const basic_batch<T> &rows, const T *w, T b, double *out)
+{
+    size_t d = rows.x.size();
+    const simd_kernels &k = simd();
+    T block[is_same<T, double>::value ? 1 : BLOCK];
+
+    for (size_t start = 0; start < rows.rows; start += BLOCK)
+    {
+        size_t m = min(BLOCK, rows.rows - start);
+        T *o;
+        if constexpr (is_same<T, double>::value)
+            o = out + start;
+        else
+            o = block;
+
+        if (d == 0)
+            fill(o, o + m, b);
+        else
+        {
+            lanes<T>::affine(k, w[0], rows.x[0] + start, b, o, m);
+            for (size_t j = 1; j < d; j++)
+                lanes<T>::axpy(k, w[j], rows.x[j] + start, o, m);
+        }
+
+        if constexpr (!is_same<T, double>::value)
+            copy(o, o + m, out + start);
+    }
+}
+
+void predict_columns(const batch &rows, const double *w, double b, double *out)
+{
+    predictColumns(rows, w, b, out);
+}
+
+void predict_columns(const batch_f &rows, const float *w, float b, double *out)
+{
+    predictColumns(rows, w, b, out);
+}
+
+void predict_rows(const double *x, size_t count, size_t d, size_t stride, const double *w, double b, double *out)
+{
+    const simd_kernels &k = simd();
+
+    // a call per row only pays off once rows are wide enough to vectorise
+    if (d >= 16)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = k.dot(x + i * stride, w, d) + b;
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const double *row = x + i * stride;
+        double s = b;
+        for (size_t j = 0; j < d; j++)
+            s += row[j] * w[j];
+        out[i] = s;
+    }
+}
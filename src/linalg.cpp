@@ -0,0 +1,215 @@
+/**
+ * @file linalg.cpp
+ * @brief Gram accumulation, Cholesky and tall-skinny QR for least squares.
+ */
+
+#include "HomemadeScikit/linalg.h"
+#include "HomemadeScikit/simd.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// rows per tile: keep the k column slices of a tile within ~64 KiB
+static size_t tileRows(size_t k)
+{
+    return max<size_t>(32, min<size_t>(1024, 8192 / k));
+}
+
+// dot products and sums of double or float slices, accumulated in double
+static double dotOf(const simd_kernels &kern, const double *x, const double *y, size_t n) { return kern.dot(x, y, n); }
+static double dotOf(const simd_kernels &kern, const float *x, const float *y, size_t n) { return kern.dot_fd(x, y, n); }
+static double sumOf(const simd_kernels &kern, const double *x, size_t n) { return kern.sum(x, n); }
+static double sumOf(const simd_kernels &kern, const float *x, size_t n) { return kern.sum_fd(x, n); }
+
+template <class T>
+static void gramUpdate(const basic_batch<T> &rows, double *G)
+{
+    size_t d = rows.x.size();
+    size_t k = d + 2;
+    size_t tile = tileRows(k);
+    const simd_kernels &kern = simd();
+
+    vector<const T *> z(k);
+    for (size_t start = 0; start < rows.rows; start += tile)
+    {
+        size_t m = min(tile, rows.rows - start);
+        for (size_t j = 0; j < d; j++)
+            z[j] = rows.x[j] + start;
+        z[d + 1] = rows.y + start;
+
+        for (size_t j = 0; j < k; j++)
+        {
+            if (j == d)
+            {
+                // the constant column: sums instead of dots
+                G[d * k + d] += m;
+                G[d * k + d + 1] += sumOf(kern, z[d + 1], m);
+                continue;
+            }
+            for (size_t l = j; l < k; l++)
+                G[j * k + l] += (l == d) ? sumOf(kern, z[j], m) : dotOf(kern, z[j], z[l], m);
+        }
+    }
+}
+
+void gram_update(const batch &rows, double *G)
+{
+    gramUpdate(rows, G);
+}
+
+void gram_update(const batch_f &rows, double *G)
+{
+    gramUpdate(rows, G);
+}
+
+bool cholesky_solve(const double *G, size_t d, double *theta)
+{
+    size_t k = d + 2;
+    size_t p = d + 1; // unknowns: weights and bias
+    vector<double> L(p * p, 0.0);
+
+    for (size_t j = 0; j < p; j++)
+    {
+        for (size_t i = j; i < p; i++)
+        {
+            double s = G[j * k + i];
+            for (size_t t = 0; t < j; t++)
+                s -= L[i * p + t] * L[j * p + t];
+            if (i == j)
+            {
+                if (!(s > 1e-12 * max(1.0, fabs(G[j * k + j]))))
+                    return false;
+                L[j * p + j] = sqrt(s);
+            }
+            else
+                L[i * p + j] = s / L[j * p + j];
+        }
+    }
+
+    // L u = Xᵀy, then Lᵀ theta = u
+    vector<double> u(p);
+    for (size_t i = 0; i < p; i++)
+    {
+        double s = G[i * k + d + 1];
+        for (size_t t = 0; t < i; t++)
+            s -= L[i * p + t] * u[t];
+        u[i] = s / L[i * p + i];
+    }
+    for (size_t i = p; i-- > 0;)
+    {
+        double s = u[i];
+        for (size_t t = i + 1; t < p; t++)
+            s -= L[t * p + i] * theta[t];
+        theta[i] = s / L[i * p + i];
+    }
+    return true;
+}
+
+/**
+ * Re-triangularise [R; A] where A holds m extra rows (column-major, lda m).
+ * Only the leading k x k upper triangle of R is read and written.
+ */
+static void householderFold(double *R, size_t k, double *A, size_t m)
+{
+    vector<double> v(m + 1);
+    for (size_t c = 0; c < k; c++)
+    {
+        // the column below the diagonal is R[c][c] followed by A[:, c]
+        double *a = A + c * m;
+        double norm2 = 0;
+        for (size_t i = 0; i < m; i++)
+            norm2 += a[i] * a[i];
+        if (norm2 == 0)
+            continue;
+
+        double rcc = R[c * k + c];
+        double alpha = -copysign(sqrt(rcc * rcc + norm2), rcc);
+        v[0] = rcc - alpha;
+        for (size_t i = 0; i < m; i++)
+            v[i + 1] = a[i];
+        double vnorm2 = v[0] * v[0] + norm2;
+
+        R[c * k + c] = alpha;
+        for (size_t i = 0; i < m; i++)
+            a[i] = 0;
+
+        // apply H = I - 2vvᵀ/vᵀv to the remaining columns
+        for (size_t l = c + 1; l < k; l++)
+        {
+            double *b = A + l * m;
+            double s = v[0] * R[c * k + l];
+            for (size_t i = 0; i < m; i++)
+                s += v[i + 1] * b[i];
+            s = 2 * s / vnorm2;
+            R[c * k + l] -= s * v[0];
+            for (size_t i = 0; i < m; i++)
+                b[i] -= s * v[i + 1];
+        }
+    }
+}
+
+template <class T>
+static void tsqrUpdate(const basic_batch<T> &rows, double *R)
+{
+    size_t d = rows.x.size();
+    size_t k = d + 2;
+    size_t tile = tileRows(k);
+    vector<double> A(tile * k);
+
+    for (size_t start = 0; start < rows.rows; start += tile)
+    {
+        size_t m = min(tile, rows.rows - start);
+        for (size_t j = 0; j < d; j++)
+            copy(rows.x[j] + start, rows.x[j] + start + m, A.begin() + j * m);
+        fill(A.begin() + d * m, A.begin() + (d + 1) * m, 1.0);
+        copy(rows.y + start, rows.y + start + m, A.begin() + (d + 1) * m);
+        householderFold(R, k, A.data(), m);
+    }
+}
+
+void tsqr_update(const batch &rows, double *R)
+{
+    tsqrUpdate(rows, R);
+}
+
+void tsqr_update(const batch_f &rows, double *R)
+{
+    tsqrUpdate(rows, R);
+}
+
+void tsqr_merge(double *R, const double *other, size_t d)
+{
+    size_t k = d + 2;
+    vector<double> A(k * k);
+    for (size_t j = 0; j < k; j++)
+        for (size_t i = 0; i < k; i++)
+            A[j * k + i] = (i <= j) ? other[i * k + j] : 0.0;
+    householderFold(R, k, A.data(), k);
+}
+
+bool triangular_solve(const double *R, size_t d, double *theta)
+{
+    size_t k = d + 2;
+    size_t p = d + 1;
+
+    double scale = 0;
+    for (size_t i = 0; i < p; i++)
+        scale = max(scale, fabs(R[i * k + i]));
+    if (scale == 0)
+        return false;
+
+    for (size_t i = p; i-- > 0;)
+    {
+        double pivot = R[i * k + i];
+        if (fabs(pivot) <= 1e-12 * scale)
+        {
+            theta[i] = 0;
+            continue;
+        }
+        double s = R[i * k + d + 1];
+        for (size_t t = i + 1; t < p; t++)
+            s -= R[i * k + t] * theta[t];
+        theta[i] = s / pivot;
+    }
+    return true;
+}
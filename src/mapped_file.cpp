@@ -0,0 +1,78 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Read-only memory mapping of files.
+ */
+
+#include "HomemadeScikit/mapped_file.h"
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::mapped_file(const string &filename)
+{
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+
+#if defined(_WIN32)
+    ifstream iFile(filename, ios::binary | ios::ate);
+    if (!iFile.is_open())
+        throw runtime_error("Cannot open file: " + filename);
+    length = iFile.tellg();
+    char *buffer = new char[length ? length : 1];
+    iFile.seekg(0);
+    iFile.read(buffer, length);
+    bytes = buffer;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("Cannot open file: " + filename);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw runtime_error("Cannot stat file: " + filename);
+    }
+    length = st.st_size;
+
+    if (length > 0)
+    {
+        void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw runtime_error("Cannot map file: " + filename);
+        }
+        madvise(p, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char *>(p);
+        mapped = true;
+    }
+    close(fd);
+#endif
+}
+
+mapped_file::~mapped_file()
+{
+    release();
+}
+
+void mapped_file::release()
+{
+#if defined(_WIN32)
+    delete[] bytes;
+#else
+    if (mapped)
+        munmap(const_cast<char *>(bytes), length);
+#endif
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+}
@@ -5,108 +5,1238 @@
 
 #include "HomemadeScikit/model.h"
 #include "HomemadeScikit/utils.h"
+#include "HomemadeScikit/kernels.h"
+#include "HomemadeScikit/linalg.h"
+#include "HomemadeScikit/simd.h"
 #include <cmath>
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+#include <iomanip>
+#include <limits>
+#include <cstring>
+#include <unordered_map>
+#include "HomemadeScikit/mapped_file.h"
 
-model::model(dataset &d) : mydata(d)
+// Binary model format (.hsm)
+static const char HSM_MAGIC[8] = {'H', 'S', 'M', 'O', 'D', 'E', 'L', '\0'};
+static const uint32_t HSM_VERSION = 3; // 2 added the feature transform, 3 the statistics
+static const uint32_t HSM_ENDIAN = 0x01020304;
+
+struct hsm_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t features;
+    uint64_t namesBytes;
+    uint64_t checksum; // fnv1a() over everything after the header
+    uint64_t flags; // low byte: transform (0 none, 1 standardize, 2 minmax); was reserved in version 1
+};
+
+static const uint64_t HSM_TRANSFORM_MASK = 0xff;
+static const uint64_t HSM_STATISTICS = 0x100; // the partial_fit statistics follow the transform
+
+static const char *const HSM_TRANSFORMS[] = {"none", "standardize", "minmax"};
+
+// FNV-1a folded over 64-bit words (then the tail bytes), so checking a
+// large weight vector costs a few cycles per weight rather than per byte
+static uint64_t fnv1a(const char *p, size_t n)
+{
+    uint64_t h = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, p + i, sizeof(word));
+        h ^= word;
+        h *= 1099511628211ull;
+    }
+    for (; i < n; i++)
+    {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+model::model() : mydata(nullptr), source(nullptr)
+{
+    b = 0;
+    n = 0;
+    J = NAN;
+}
+
+model::model(dataset &d) : mydata(&d), source(nullptr)
 {
     b = 0;
-    n = mydata.rows();
-    for (int i = 0; i < mydata.settings.x.size(); i++)
+    n = mydata->rows();
+    for (size_t i = 0; i < mydata->settings.x.size(); i++)
     {
         w.push_back(0);
     }
+    for (auto it = mydata->settings.x.rbegin(); it != mydata->settings.x.rend(); ++it)
+        names.push_back(mydata->data[*it].header);
+
+    inputs = w.size();
+    categoryAt.assign(inputs, -1);
+    for (size_t j = 0; j < inputs; j++)
+    {
+        const column &c = mydata->data[mydata->settings.x[inputs - 1 - j]];
+        if (!c.isCategory())
+            continue;
+        categoryAt[j] = categories.size();
+        category_feature &f = categories.emplace_back();
+        f.position = j;
+        f.levels = c.levels();
+    }
+    if (!categories.empty())
+        encodeCategories(model_settings());
 
     calcJ();
 }
 
-void model::calcJ()
+model::model(row_source &s) : mydata(nullptr), source(&s)
+{
+    b = 0;
+    n = 0;
+    w.assign(source->features(), 0);
+    names = source->featureNames();
+    J = NAN;
+}
+
+bool model::floatColumns(dataset &data)
+{
+    size_t floats = 0, total = 0;
+    for (int i : data.settings.x)
+        floats += data.data[i].isFloat(), total++;
+    if (data.settings.y >= 0)
+        floats += data.data[data.settings.y].isFloat(), total++;
+    if (floats != 0 && floats != total)
+        throw runtime_error("model: the chosen columns mix float and double (see dataset::setPrecision)");
+    return total && floats == total;
+}
+
+void model::datasetBatch(dataset &data, batch &rows)
+{
+    // weights follow dataset::getRow, which lists features in reverse
+    rows.rows = data.rows();
+    rows.x.clear();
+    for (auto it = data.settings.x.rbegin(); it != data.settings.x.rend(); ++it)
+    {
+        if (data.data[*it].isCategory())
+            throw runtime_error("model: " + data.data[*it].header + " is a category column the model was not built with");
+        rows.x.push_back(data.data[*it].data());
+    }
+    rows.y = (data.settings.y >= 0) ? data.data[data.settings.y].data() : nullptr;
+}
+
+void model::datasetBatch(dataset &data, batch_f &rows)
+{
+    rows.rows = data.rows();
+    rows.x.clear();
+    for (auto it = data.settings.x.rbegin(); it != data.settings.x.rend(); ++it)
+        rows.x.push_back(data.data[*it].floatData());
+    rows.y = (data.settings.y >= 0) ? data.data[data.settings.y].floatData() : nullptr;
+}
+
+// the per-thread slices of a batch of either element type
+template <class T>
+static vector<basic_batch<T>> &slicesOf(vector<batch> &parts, vector<batch_f> &partsF)
+{
+    if constexpr (is_same<T, float>::value)
+        return partsF;
+    else
+        return parts;
+}
+
+// below this many rows the unrolled per-row kernel beats the vector one
+static const size_t FIXED_BLOCK_ROWS = 64;
+
+void model::fused(const batch &rows, double *gw, double &gb, double &cost)
+{
+    if (fixed && rows.rows < FIXED_BLOCK_ROWS)
+        fixed->fusedGradient(rows, w.data(), b, gw, gb, cost);
+    else
+        fused_gradient(rows, w.data(), b, gw, gb, cost);
+}
+
+void model::fused(const batch_f &rows, double *gw, double &gb, double &cost)
+{
+    fused_gradient(rows, wf.data(), float(b), gw, gb, cost, wide);
+}
+
+// rows of a categorical pass handled at once: their predictions (then
+// residuals) stay in cache while every feature adds to them
+static const size_t CATEGORY_BLOCK_ROWS = 4096;
+
+void model::encodeCategories(const model_settings &m)
+{
+    if (m.encoding != "onehot" && m.encoding != "target")
+        throw runtime_error("model: unknown encoding \"" + m.encoding + "\"");
+    if (m.encoding != encoding)
+    {
+        // a new layout starts the category weights from 0
+        w.resize(inputs);
+        names.resize(inputs);
+        for (category_feature &f : categories)
+        {
+            w[f.position] = 0;
+            f.offset = 0;
+            f.encoded.clear();
+            if (m.encoding != "onehot")
+                continue;
+            f.offset = w.size();
+            w.resize(w.size() + f.levels->size(), 0.0);
+            for (const string &level : *f.levels)
+                names.push_back(names[f.position] + "=" + level);
+        }
+        encoding = m.encoding;
+    }
+    if (encoding != "target")
+        return;
+
+    // each level's mean target over the training rows, smoothed toward the overall mean
+    if (mydata->settings.y < 0 || !mydata->data[mydata->settings.y].data())
+        throw runtime_error("model: target encoding needs a double target column");
+    const double *y = mydata->data[mydata->settings.y].data();
+    size_t total = mydata->rows();
+    double prior = total ? simd().sum(y, total) / total : 0.0;
+    vector<double> sums;
+    vector<size_t> counts;
+    for (category_feature &f : categories)
+    {
+        size_t levels = f.levels->size();
+        const uint32_t *code = mydata->data[mydata->settings.x[inputs - 1 - f.position]].codeData();
+        sums.assign(levels, 0.0);
+        counts.assign(levels, 0);
+        for (size_t i = 0; i < total; i++)
+            if (code[i] < levels)
+            {
+                sums[code[i]] += y[i];
+                counts[code[i]]++;
+            }
+        f.encoded.resize(levels + 1);
+        for (size_t k = 0; k < levels; k++)
+            f.encoded[k] = counts[k] ? (sums[k] + m.smoothing * prior) / (counts[k] + m.smoothing) : prior;
+        f.encoded[levels] = prior;
+    }
+}
+
+void model::categoricalPass(dataset &data, double *gw, double &gb, double &cost, double *out)
+{
+    size_t d = inputs;
+    if (data.settings.x.size() != d)
+        throw runtime_error("predict: input size mismatch");
+    if (!out && (data.settings.y < 0 || !data.data[data.settings.y].data()))
+        throw runtime_error("model: category features need a double target column");
+
+    // numeric inputs in rows.x, category ones in `codes`, each mapped onto
+    // the training dictionary by level name when it has its own
+    rows.x.assign(d, nullptr);
+    codes.assign(d, nullptr);
+    remap.resize(categories.size());
+    for (size_t j = 0; j < d; j++)
+    {
+        const column &c = data.data[data.settings.x[d - 1 - j]];
+        int k = categoryAt[j];
+        if (k < 0)
+        {
+            if (!c.data())
+                throw runtime_error("model: " + c.header + " must be a double column, as in training");
+            rows.x[j] = c.data();
+            continue;
+        }
+        if (!c.isCategory())
+            throw runtime_error("model: " + c.header + " must be a category column, as in training");
+        codes[j] = c.codeData();
+        remap[k].clear();
+        const vector<string> &known = *categories[k].levels;
+        if (c.levels() == categories[k].levels)
+            continue;
+        unordered_map<string_view, uint32_t> index;
+        for (size_t l = 0; l < known.size(); l++)
+            index.emplace(known[l], uint32_t(l));
+        for (const string &level : *c.levels())
+        {
+            auto found = index.find(level);
+            remap[k].push_back(found == index.end() ? NO_LEVEL : found->second);
+        }
+    }
+
+    const simd_kernels &kern = simd();
+    const double *y = out ? nullptr : data.data[data.settings.y].data();
+    bool onehot = encoding == "onehot";
+    size_t total = data.rows();
+    residuals.resize(min(total, CATEGORY_BLOCK_ROWS));
+    for (size_t begin = 0; begin < total; begin += CATEGORY_BLOCK_ROWS)
+    {
+        size_t count = min(CATEGORY_BLOCK_ROWS, total - begin);
+        double *p = out ? out + begin : residuals.data();
+        fill(p, p + count, b);
+        for (size_t j = 0; j < d; j++)
+        {
+            if (rows.x[j])
+            {
+                kern.axpy(w[j], rows.x[j] + begin, p, count);
+                continue;
+            }
+            const category_feature &f = categories[categoryAt[j]];
+            const vector<uint32_t> &map = remap[categoryAt[j]];
+            const uint32_t *code = codes[j] + begin;
+            size_t levels = f.levels->size();
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t c = map.empty() ? code[i] : code[i] < map.size() ? map[code[i]] : NO_LEVEL;
+                if (onehot)
+                    p[i] += c < levels ? w[f.offset + c] : 0.0;
+                else
+                    p[i] += w[j] * f.encoded[min<size_t>(c, levels)];
+            }
+        }
+        if (out)
+            continue;
+
+        // the predictions become the residuals
+        kern.axpy(-1.0, y + begin, p, count);
+        gb += kern.sum(p, count);
+        cost += kern.sum_squares(p, count);
+        if (!gw)
+            continue;
+        for (size_t j = 0; j < d; j++)
+        {
+            if (rows.x[j])
+            {
+                gw[j] += kern.dot(p, rows.x[j] + begin, count);
+                continue;
+            }
+            const category_feature &f = categories[categoryAt[j]];
+            const vector<uint32_t> &map = remap[categoryAt[j]];
+            const uint32_t *code = codes[j] + begin;
+            size_t levels = f.levels->size();
+            double sum = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t c = map.empty() ? code[i] : code[i] < map.size() ? map[code[i]] : NO_LEVEL;
+                if (!onehot)
+                    sum += p[i] * f.encoded[min<size_t>(c, levels)];
+                else if (c < levels)
+                    gw[f.offset + c] += p[i];
+            }
+            gw[j] += sum;
+        }
+    }
+}
+
+void model::narrowWeights()
+{
+    wf.assign(w.begin(), w.end());
+}
+
+void model::forRanges(size_t count, const function<void(size_t, size_t)> &fn)
+{
+    if (!pool || count < 2048 * pool->size())
+    {
+        fn(0, count);
+        return;
+    }
+    size_t t = pool->size();
+    pool->run(t, [&](size_t p)
+              { fn(count * p / t, count * (p + 1) / t); });
+}
+
+template <class T>
+void model::split(const basic_batch<T> &rows, size_t t, vector<basic_batch<T>> &parts)
+{
+    size_t d = rows.x.size();
+    parts.resize(t);
+    for (size_t p = 0; p < t; p++)
+    {
+        size_t begin = rows.rows * p / t;
+        size_t end = rows.rows * (p + 1) / t;
+        parts[p].rows = end - begin;
+        parts[p].x.resize(d);
+        for (size_t j = 0; j < d; j++)
+            parts[p].x[j] = rows.x[j] + begin;
+        parts[p].y = rows.y + begin;
+    }
+}
+
+template <class T>
+void model::accumulate(const basic_batch<T> &rows, double *gw, double &gb, double &cost)
+{
+    // small batches are not worth waking the workers
+    if (!pool || rows.rows < 2048 * pool->size())
+    {
+        fused(rows, gw, gb, cost);
+        return;
+    }
+
+    size_t t = pool->size();
+    size_t d = w.size();
+    vector<basic_batch<T>> &slices = slicesOf<T>(parts, partsF);
+    split(rows, t, slices);
+    partials.assign(t * (d + 2), 0.0);
+
+    pool->run(t, [&](size_t p)
+              {
+        double *sums = &partials[p * (d + 2)];
+        fused(slices[p], gw ? sums : nullptr, sums[d], sums[d + 1]); });
+
+    // fixed order, so the result depends only on the thread count
+    for (size_t p = 0; p < t; p++)
+    {
+        const double *sums = &partials[p * (d + 2)];
+        if (gw)
+            for (size_t j = 0; j < d; j++)
+                gw[j] += sums[j];
+        gb += sums[d];
+        cost += sums[d + 1];
+    }
+}
+
+void model::pass(double *gw, double &gb, double &cost)
 {
-    J = 0;
-    for (int i = 0; i < n; i++)
+    gb = 0;
+    cost = 0;
+    if (gw)
+        fill(gw, gw + w.size(), 0.0);
+
+    if (!mydata && !source)
+        throw runtime_error("model: no training data");
+
+    if (!source)
     {
-        J += pow(dot(mydata.getRow(i), w) + b - mydata.data[mydata.settings.getY()].data[i].first, 2);
+        if (!categories.empty())
+        {
+            categoricalPass(*mydata, gw, gb, cost, nullptr);
+            return;
+        }
+        if (floatColumns(*mydata))
+        {
+            narrowWeights();
+            datasetBatch(*mydata, rowsF);
+            accumulate(rowsF, gw, gb, cost);
+            return;
+        }
+        datasetBatch(*mydata, rows);
+        accumulate(rows, gw, gb, cost);
+        return;
     }
+
+    n = 0;
+    source->rewind();
+    while (source->next(rows))
+    {
+        accumulate(rows, gw, gb, cost);
+        n += rows.rows;
+    }
+    if (n == 0)
+        throw runtime_error("model: the source yielded no rows");
+}
+
+void model::calcJ()
+{
+    double gb;
+    pass(nullptr, gb, J);
     J /= (2 * n);
 }
 
-void model::logValues(int i)
+double model::calcJ(row_source &data)
+{
+    if (!categories.empty())
+        throw runtime_error("calcJ: a model with category features scores datasets only");
+    if (data.features() != w.size())
+        throw runtime_error("calcJ: input size mismatch");
+    double gb = 0, cost = 0;
+    size_t count = 0;
+    batch part;
+    data.rewind();
+    while (data.next(part))
+    {
+        accumulate(part, nullptr, gb, cost);
+        count += part.rows;
+    }
+    if (count == 0)
+        throw runtime_error("model: the source yielded no rows");
+    return cost / (2 * count);
+}
+
+void model::notify(const model_settings &m, int epoch, double gradNorm, double passSeconds, double updateSeconds)
+{
+    double seconds = passSeconds + updateSeconds;
+    m.observer->onEpoch({epoch, J, gradNorm, passSeconds, updateSeconds, size_t(n),
+                         seconds > 0 ? n / seconds : NAN});
+}
+
+void model::calculateGrad(grad &out, double &cost)
+{
+    out.w.resize(w.size());
+    pass(out.w.data(), out.b, cost);
+
+    out.b /= n;
+    out.w /= n;
+    cost /= (2 * n);
+}
+
+void model::gradientIter(const grad &gradient, const double a)
+{
+    if (scale.empty())
+    {
+        w -= a * gradient.w;
+        b = b - a * gradient.b;
+        return;
+    }
+
+    // the step taken on the scaled weights w'_j = w_j * scale_j and
+    // b' = b + Σ w_j * shift_j, mapped back onto the raw ones
+    double db = 0;
+    for (size_t j = 0; j < w.size(); j++)
+    {
+        double dw = a * (gradient.w[j] - shift[j] * gradient.b) / (scale[j] * scale[j]);
+        w[j] -= dw;
+        db += dw * shift[j];
+    }
+    b = b - a * gradient.b + db;
+}
+
+void model::fitTransform(const model_settings &m)
+{
+    scaling = m.scale;
+    shift.clear();
+    scale.clear();
+    if (m.scale == "none")
+        return;
+    if (m.scale != "standardize" && m.scale != "minmax")
+        throw runtime_error("model: unknown scale \"" + m.scale + "\"");
+
+    size_t d = w.size();
+    vector<column_stats> features(d);
+    if (!source)
+    {
+        // weight j is settings.x[d - 1 - j] (see datasetBatch)
+        for (size_t j = 0; j < d; j++)
+            features[j] = mydata->data[mydata->settings.x[d - 1 - j]].stats();
+    }
+    else
+    {
+        // a source has no cached statistics: one extra pass gathers them
+        source->rewind();
+        while (source->next(rows))
+            for (size_t j = 0; j < d; j++)
+                features[j] = merge(features[j], summarize(rows.x[j], nullptr, rows.rows));
+    }
+
+    shift.resize(d);
+    scale.resize(d);
+    for (size_t j = 0; j < d; j++)
+    {
+        const column_stats &f = features[j];
+        bool standard = (m.scale == "standardize");
+        shift[j] = f.count ? (standard ? f.mean : f.min) : 0.0;
+        scale[j] = f.count ? (standard ? sqrt(f.variance) : f.max - f.min) : 1.0;
+        // a constant feature has nothing to rescale
+        if (!(scale[j] > 0) || !isfinite(scale[j]))
+            scale[j] = 1.0;
+    }
+}
+
+bool model::shouldStop(const model_settings &m, int epoch, double gradNorm, const stopwatch &started)
+{
+    outcome.epochs = epoch + 1;
+    if (m.gradTolerance > 0 && gradNorm < m.gradTolerance)
+    {
+        outcome.reason = STOP_GRADIENT;
+        return true;
+    }
+    if (m.tolerance > 0 && !isnan(previousJ))
+    {
+        double change = fabs(previousJ - J) / max(fabs(previousJ), numeric_limits<double>::min());
+        calm = change < m.tolerance ? calm + 1 : 0;
+        if (calm >= max(m.patience, 1))
+        {
+            outcome.reason = STOP_COST;
+            return true;
+        }
+    }
+    previousJ = J;
+    if (m.timeLimit > 0 && started.elapsed() >= m.timeLimit)
+    {
+        outcome.reason = STOP_TIME;
+        return true;
+    }
+    if (m.cancel && m.cancel->load(memory_order_relaxed))
+    {
+        outcome.reason = STOP_CANCELLED;
+        return true;
+    }
+    return false;
+}
+
+void model::gradientDescent(const model_settings &m)
 {
+    int interval = m.interval > 0 ? m.interval : 1;
+    bool needNorm = m.observer || m.gradTolerance > 0;
+    stopwatch started, clock;
+
+    for (int i = 0; i < m.epochs; i++)
+    {
+        bool observed = m.observer && i % interval == 0;
+        if (observed)
+            clock.lap();
+
+        // the pass that yields the gradient also yields J for the current weights
+        calculateGrad(gradient, J);
+        double passSeconds = observed ? clock.lap() : 0;
+
+        double norm = NAN;
+        if (needNorm)
+        {
+            const simd_kernels &k = simd();
+            norm = sqrt(k.sum_squares(gradient.w.data(), gradient.w.size()) + gradient.b * gradient.b);
+        }
+
+        bool stop = shouldStop(m, i, norm, started);
+        // at a flat enough point there is no step left to take, and J is current
+        if (stop && outcome.reason == STOP_GRADIENT)
+        {
+            if (observed)
+                notify(m, i, norm, passSeconds, 0);
+            return;
+        }
+        gradientIter(gradient, m.step);
+
+        if (observed)
+            notify(m, i, norm, passSeconds, clock.lap());
+        if (stop)
+            break;
+    }
     calcJ();
-    printf("_________iteration: %d_________\n", i);
-    printf("w: ");
-    for (double wi : w)
-        printf("%lf ", wi);
-    printf("\nb: %lf\nJ: %lf\n", b, J);
-    printf("_______________________________\n");
 }
 
-grad model::calculateGrad()
+template <class T>
+void model::stochasticEpoch(const basic_batch<T> &rows, const model_settings &m, mt19937_64 &rng, double &cost)
 {
-    grad grad;
-    grad.b = 0;
-    double y_i;
-    vector<double> row;
+    size_t size = m.batch > 0 ? m.batch : 1;
+    size_t blocks = (rows.rows + size - 1) / size;
+    size_t d = w.size();
+    double a = m.step;
+
+    order.resize(blocks);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), rng);
 
-    for (int i = 0; i < mydata.settings.x.size(); i++)
-        grad.w.push_back(0);
+    vector<basic_batch<T>> &slices = slicesOf<T>(parts, partsF);
+    basic_batch<T> &block = slices.empty() ? slices.emplace_back() : slices[0];
+    block.x.resize(d);
 
-    for (int i = 0; i < n; i++)
+    for (size_t k : order)
     {
-        row = mydata.getRow(i);
-        y_i = mydata.data[mydata.settings.getY()].data[i].first;
+        size_t begin = k * size;
+        size_t count = min(size, rows.rows - begin);
 
-        for (int j = 0; j < mydata.settings.x.size(); j++)
+        if (m.algo == "minibatch")
+        {
+            block.rows = count;
+            for (size_t j = 0; j < d; j++)
+                block.x[j] = rows.x[j] + begin;
+            block.y = rows.y + begin;
+
+            double gb = 0;
+            fill(gradient.w.begin(), gradient.w.end(), 0.0);
+            if constexpr (is_same<T, float>::value)
+                narrowWeights();
+            fused(block, gradient.w.data(), gb, cost);
+            gradient.b = gb / count;
+            gradient.w /= count;
+            gradientIter(gradient, a);
+            continue;
+        }
+
+        // sgd: the block is hot in cache, so visiting its rows in random order is cheap
+        rowOrder.resize(count);
+        iota(rowOrder.begin(), rowOrder.end(), begin);
+        shuffle(rowOrder.begin(), rowOrder.end(), rng);
+        if constexpr (is_same<T, double>::value)
+        {
+            if (fixed)
+            {
+                bool scaled = !scale.empty();
+                fixed->sgdRows(rows, rowOrder.data(), count, a, scaled ? shift.data() : nullptr,
+                               scaled ? scale.data() : nullptr, w.data(), b, cost);
+                continue;
+            }
+        }
+        for (size_t i : rowOrder)
         {
-            grad.w[j] += (dot(row, w) + b - y_i) * row[j];
+            double r = b - rows.y[i];
+            for (size_t j = 0; j < d; j++)
+                r += w[j] * rows.x[j][i];
+            if (scale.empty())
+            {
+                for (size_t j = 0; j < d; j++)
+                    w[j] -= a * r * rows.x[j][i];
+                b -= a * r;
+            }
+            else
+            {
+                // same mapping as gradientIter, for a one-row gradient
+                double db = 0;
+                for (size_t j = 0; j < d; j++)
+                {
+                    double dw = a * r * (rows.x[j][i] - shift[j]) / (scale[j] * scale[j]);
+                    w[j] -= dw;
+                    db += dw * shift[j];
+                }
+                b -= a * r - db;
+            }
+            cost += r * r;
         }
-        grad.b += dot(row, w) + b - y_i;
     }
+}
+
+void model::stochasticDescent(const model_settings &m)
+{
+    mt19937_64 rng(m.seed);
+    gradient.w.resize(w.size());
 
-    grad.b /= n;
-    grad.w /= n;
+    int interval = m.interval > 0 ? m.interval : 1;
+    stopwatch started, clock;
+    for (int i = 0; i < m.epochs; i++)
+    {
+        bool observed = m.observer && i % interval == 0;
+        if (observed)
+            clock.lap();
 
-    return grad;
+        // J is the running cost seen while the weights moved during the epoch
+        double cost = 0;
+        if (!mydata && !source)
+            throw runtime_error("model: no training data");
+        if (!source && floatColumns(*mydata))
+        {
+            datasetBatch(*mydata, rowsF);
+            stochasticEpoch(rowsF, m, rng, cost);
+        }
+        else if (!source)
+        {
+            datasetBatch(*mydata, rows);
+            stochasticEpoch(rows, m, rng, cost);
+        }
+        else
+        {
+            n = 0;
+            source->rewind();
+            while (source->next(rows))
+            {
+                stochasticEpoch(rows, m, rng, cost);
+                n += rows.rows;
+            }
+        }
+        J = cost / (2 * n);
+        if (observed)
+            notify(m, i, NAN, clock.lap(), 0);
+        if (shouldStop(m, i, NAN, started))
+            break;
+    }
+    calcJ();
 }
 
-void model::gradientIter(const double a)
+template <class T>
+void model::factorize(const basic_batch<T> &rows, bool qr, double *S)
 {
-    grad gradient = calculateGrad();
+    size_t d = w.size();
+    size_t k = d + 2;
+
+    if (!pool || rows.rows < 2048 * pool->size())
+    {
+        qr ? tsqr_update(rows, S) : gram_update(rows, S);
+        return;
+    }
+
+    // one private matrix per row range, folded in range order
+    size_t t = pool->size();
+    vector<basic_batch<T>> &slices = slicesOf<T>(parts, partsF);
+    split(rows, t, slices);
+    partials.assign(t * k * k, 0.0);
+    pool->run(t, [&](size_t p)
+              {
+        double *mine = &partials[p * k * k];
+        qr ? tsqr_update(slices[p], mine) : gram_update(slices[p], mine); });
 
-    w -= a * gradient.w;
-    b = b - a * gradient.b;
+    for (size_t p = 0; p < t; p++)
+    {
+        const double *mine = &partials[p * k * k];
+        if (qr)
+            tsqr_merge(S, mine, d);
+        else
+            for (size_t i = 0; i < k * k; i++)
+                S[i] += mine[i];
+    }
 }
 
-void model::gradientDescent(const int n, const double a)
+void model::solveClosedForm(const model_settings &m)
 {
-    for (int i = 0; i < n; i++)
+    bool qr = (m.algo == "qr");
+    size_t d = w.size();
+    vector<double> S((d + 2) * (d + 2), 0.0);
+
+    if (!mydata && !source)
+        throw runtime_error("model: no training data");
+
+    stopwatch clock;
+    if (!source && floatColumns(*mydata))
+    {
+        datasetBatch(*mydata, rowsF);
+        factorize(rowsF, qr, S.data());
+    }
+    else if (!source)
     {
-        gradientIter(a);
-        if (i % 100 == 0)
-            logValues(i);
+        datasetBatch(*mydata, rows);
+        factorize(rows, qr, S.data());
     }
+    else
+    {
+        n = 0;
+        source->rewind();
+        while (source->next(rows))
+        {
+            factorize(rows, qr, S.data());
+            n += rows.rows;
+        }
+    }
+
+    double passSeconds = clock.lap();
+
+    vector<double> theta(d + 1);
+    if (qr ? !triangular_solve(S.data(), d, theta.data()) : !cholesky_solve(S.data(), d, theta.data()))
+        throw runtime_error(qr ? "qr: no rows to fit" : "normal: XᵀX is not positive definite (try algo = \"qr\")");
+
+    copy(theta.begin(), theta.begin() + d, w.begin());
+    b = theta[d];
+
+    // later partial_fit calls continue from these rows: the Gram matrix
+    // as is, or RᵀR for the QR factor
+    size_t k = d + 2;
+    if (!qr)
+        gram = S;
+    else
+    {
+        gram.assign(k * k, 0.0);
+        for (size_t i = 0; i < k; i++)
+            for (size_t j = i; j < k; j++)
+                for (size_t l = 0; l <= i; l++)
+                    gram[i * k + j] += S[l * k + i] * S[l * k + j];
+    }
+    double solveSeconds = clock.lap();
     calcJ();
+    if (m.observer)
+        notify(m, 0, NAN, passSeconds, solveSeconds);
 }
 
-void model::train(const model_settings &m)
+void model::beginStatistics(size_t features)
 {
-    if (m.algo == "gradient")
-        gradientDescent(m.epochs, m.step);
+    if (!categories.empty())
+        throw runtime_error("partial_fit: the statistics cannot hold category features");
+    if (w.empty() && gram.empty())
+        w.assign(features, 0.0);
+    if (w.size() != features)
+        throw runtime_error("partial_fit: the rows have " + to_string(features) + " features, the model " +
+                            to_string(w.size()));
+    size_t k = features + 2;
+    if (gram.empty())
+        gram.assign(k * k, 0.0);
+}
+
+size_t model::getSeen()
+{
+    size_t d = w.size();
+    return gram.empty() ? 0 : size_t(gram[d * (d + 2) + d]);
+}
+
+void model::statisticsTransform(const model_settings &m)
+{
+    scaling = m.scale;
+    shift.clear();
+    scale.clear();
+    if (m.scale == "none")
+        return;
+    if (m.scale == "minmax")
+        throw runtime_error("partial_fit: minmax scaling needs column ranges, which the statistics do not keep");
+    if (m.scale != "standardize")
+        throw runtime_error("model: unknown scale \"" + m.scale + "\"");
+
+    // mean and variance from Σx and Σx², as fitTransform gets them from the columns
+    size_t d = w.size(), k = d + 2;
+    double rows = gram[d * k + d];
+    shift.resize(d);
+    scale.resize(d);
+    for (size_t j = 0; j < d; j++)
+    {
+        double mean = rows > 0 ? gram[j * k + d] / rows : 0.0;
+        shift[j] = mean;
+        scale[j] = rows > 0 ? sqrt(max(0.0, gram[j * k + j] / rows - mean * mean)) : 1.0;
+        if (!(scale[j] > 0) || !isfinite(scale[j]))
+            scale[j] = 1.0;
+    }
+}
+
+void model::statisticsGrad(grad &out, double &cost)
+{
+    // with t = [w, b, -1], ZᵀZ t stacks the residual sums Σ r·x and Σ r,
+    // and tᵀ ZᵀZ t is Σ r²
+    size_t d = w.size(), k = d + 2;
+    vector<double> t(w);
+    t.push_back(b);
+    t.push_back(-1);
+
+    double total = 0;
+    out.w.resize(d);
+    for (size_t i = 0; i < k; i++)
+    {
+        double v = 0;
+        for (size_t j = 0; j < k; j++)
+            v += gram[min(i, j) * k + max(i, j)] * t[j];
+        total += t[i] * v;
+        if (i < d)
+            out.w[i] = v / n;
+        else if (i == d)
+            out.b = v / n;
+    }
+    // rounding can take a near-perfect fit's Σ r² just below zero
+    cost = max(0.0, total) / (2 * n);
+}
+
+train_report model::refit(const model_settings &m, const stopwatch &started)
+{
+    outcome = train_report();
+    previousJ = NAN;
+    calm = 0;
+    n = getSeen();
+    if (n == 0)
+        throw runtime_error("partial_fit: no rows to fit");
+    statisticsTransform(m);
+
+    size_t d = w.size();
+    if (m.algo == "normal")
+    {
+        stopwatch clock;
+        vector<double> theta(d + 1);
+        if (!cholesky_solve(gram.data(), d, theta.data()))
+            throw runtime_error("partial_fit: XᵀX is not positive definite yet (too few or collinear rows)");
+        copy(theta.begin(), theta.begin() + d, w.begin());
+        b = theta[d];
+        statisticsGrad(gradient, J);
+        outcome.reason = STOP_SOLVED;
+        outcome.epochs = 1;
+        if (m.observer)
+            notify(m, 0, NAN, 0, clock.lap());
+    }
+    else if (m.algo == "gradient")
+    {
+        int interval = m.interval > 0 ? m.interval : 1;
+        stopwatch clock;
+        for (int i = 0; i < m.epochs; i++)
+        {
+            bool observed = m.observer && i % interval == 0;
+            if (observed)
+                clock.lap();
+            statisticsGrad(gradient, J);
+            double norm = sqrt(inner_product(gradient.w.begin(), gradient.w.end(), gradient.w.begin(), 0.0) +
+                               gradient.b * gradient.b);
+            bool stop = shouldStop(m, i, norm, started);
+            if (stop && outcome.reason == STOP_GRADIENT)
+                break;
+            gradientIter(gradient, m.step);
+            if (observed)
+                notify(m, i, norm, 0, clock.lap());
+            if (stop)
+                break;
+        }
+        statisticsGrad(gradient, J);
+    }
+    else
+        throw runtime_error("partial_fit: algo must be \"normal\" or \"gradient\"");
+
+    // a borrowed pool is only lent for the call
+    pool = owned.get();
+    outcome.cost = J;
+    outcome.seconds = started.elapsed();
+    return outcome;
+}
+
+train_report model::partial_fit(dataset &data, const model_settings &m)
+{
+    stopwatch started;
+    if (data.settings.y < 0)
+        throw runtime_error("partial_fit: the dataset has no target column");
+    usePool(m);
+    beginStatistics(data.settings.x.size());
+    if (names.empty())
+        for (auto it = data.settings.x.rbegin(); it != data.settings.x.rend(); ++it)
+            names.push_back(data.data[*it].header);
+
+    if (floatColumns(data))
+    {
+        datasetBatch(data, rowsF);
+        factorize(rowsF, false, gram.data());
+    }
+    else
+    {
+        datasetBatch(data, rows);
+        factorize(rows, false, gram.data());
+    }
+    return refit(m, started);
+}
+
+train_report model::partial_fit(row_source &data, const model_settings &m)
+{
+    stopwatch started;
+    usePool(m);
+    beginStatistics(data.features());
+    if (names.empty())
+        names = data.featureNames();
+
+    data.rewind();
+    while (data.next(rows))
+        factorize(rows, false, gram.data());
+    return refit(m, started);
+}
+
+train_report model::partial_fit(const batch &data, const model_settings &m)
+{
+    stopwatch started;
+    usePool(m);
+    beginStatistics(data.x.size());
+    factorize(data, false, gram.data());
+    return refit(m, started);
+}
+
+void model::setThreads(int count)
+{
+    size_t threads = thread_pool::resolve(count < 0 ? 1 : count);
+    if (threads == 1)
+        owned.reset();
+    else if (!owned || owned->size() != threads)
+        owned = make_unique<thread_pool>(threads);
+    pool = owned.get();
+}
+
+void model::usePool(const model_settings &m)
+{
+    if (!m.pool)
+        setThreads(m.threads);
     else
-        cout << "ERROR: inexistent model type" << endl;
+        pool = m.pool->size() > 1 ? m.pool : nullptr;
+}
+
+const char *stop_reason_name(stop_reason reason)
+{
+    switch (reason)
+    {
+    case STOP_EPOCHS:
+        return "epochs";
+    case STOP_COST:
+        return "cost";
+    case STOP_GRADIENT:
+        return "gradient";
+    case STOP_TIME:
+        return "time";
+    case STOP_SOLVED:
+        return "solved";
+    case STOP_CANCELLED:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+train_report model::train(const model_settings &m)
+{
+    stopwatch started;
+    if (m.algo != "gradient" && m.algo != "minibatch" && m.algo != "sgd" && m.algo != "normal" && m.algo != "qr")
+        throw runtime_error("model: unknown algo \"" + m.algo + "\"");
+    if (!categories.empty())
+    {
+        if (m.algo != "gradient" || m.scale != "none")
+            throw runtime_error("model: category features train with algo \"gradient\" and scale \"none\"");
+        encodeCategories(m);
+    }
+    usePool(m);
+    outcome = train_report();
+    previousJ = NAN;
+    calm = 0;
+    wide = m.wideSums;
+    fixed = m.specialize ? fixed_kernels_for(w.size()) : nullptr;
+    if (!mydata && !source)
+        throw runtime_error("model: no training data");
+    fitTransform(m);
+
+    if (m.algo == "gradient" || m.algo == "minibatch" || m.algo == "sgd")
+        gram.clear();
+
+    if (m.algo == "gradient")
+        gradientDescent(m);
+    else if (m.algo == "minibatch" || m.algo == "sgd")
+        stochasticDescent(m);
+    else if (m.algo == "normal" || m.algo == "qr")
+    {
+        solveClosedForm(m);
+        outcome.reason = STOP_SOLVED;
+        outcome.epochs = 1;
+    }
+
+    // a borrowed pool is only lent for the call
+    pool = owned.get();
+    outcome.cost = J;
+    outcome.seconds = started.elapsed();
+    return outcome;
 }
 
 double model::predict(const vector<double> &x)
 {
+    if (!categories.empty())
+    {
+        if (x.size() != inputs)
+            throw runtime_error("predict: input size mismatch");
+        double sum = b;
+        for (size_t j = 0; j < inputs; j++)
+        {
+            if (categoryAt[j] < 0)
+            {
+                sum += w[j] * x[j];
+                continue;
+            }
+            const category_feature &f = categories[categoryAt[j]];
+            size_t levels = f.levels->size();
+            bool known = x[j] >= 0 && x[j] < levels;
+            if (encoding == "onehot")
+                sum += known ? w[f.offset + size_t(x[j])] : 0.0;
+            else
+                sum += w[j] * f.encoded[known ? size_t(x[j]) : levels];
+        }
+        return sum;
+    }
     if (x.size() != w.size())
         throw runtime_error("predict: input size mismatch");
+    if (const fixed_kernels *f = fixed_kernels_for(w.size()))
+        return f->predict(w.data(), b, x.data());
     return dot(x, w) + b;
 }
 
+void model::predict(dataset &data, double *out, size_t size)
+{
+    if (!categories.empty())
+    {
+        if (size != size_t(data.rows()))
+            throw runtime_error("predict: output size mismatch");
+        double gb = 0, cost = 0;
+        categoricalPass(data, nullptr, gb, cost, out);
+        return;
+    }
+    if (floatColumns(data))
+    {
+        batch_f columns;
+        datasetBatch(data, columns);
+        predict(columns, out, size);
+        return;
+    }
+    batch columns;
+    datasetBatch(data, columns);
+    predict(columns, out, size);
+}
+
+template <class T>
+void model::predictBatch(const basic_batch<T> &columns, double *out, size_t size)
+{
+    if (!categories.empty())
+        throw runtime_error("predict: a model with category features scores datasets only");
+    if (columns.x.size() != w.size())
+        throw runtime_error("predict: input size mismatch");
+    if (size != columns.rows)
+        throw runtime_error("predict: output size mismatch");
+
+    const T *weights;
+    vector<float> narrowed;
+    if constexpr (is_same<T, float>::value)
+    {
+        narrowed.assign(w.begin(), w.end());
+        weights = narrowed.data();
+    }
+    else
+        weights = w.data();
+
+    const fixed_kernels *f = is_same<T, double>::value ? fixed_kernels_for(w.size()) : nullptr;
+    forRanges(columns.rows, [&](size_t begin, size_t end)
+              {
+        basic_batch<T> part;
+        part.rows = end - begin;
+        for (const T *x : columns.x)
+            part.x.push_back(x + begin);
+        if constexpr (is_same<T, double>::value)
+        {
+            if (f)
+            {
+                f->predictColumns(part, weights, b, out + begin);
+                return;
+            }
+        }
+        predict_columns(part, weights, T(b), out + begin); });
+}
+
+void model::predict(const batch &columns, double *out, size_t size)
+{
+    predictBatch(columns, out, size);
+}
+
+void model::predict(const batch_f &columns, double *out, size_t size)
+{
+    predictBatch(columns, out, size);
+}
+
+void model::predict(row_source &rows, double *out, size_t size)
+{
+    if (!categories.empty())
+        throw runtime_error("predict: a model with category features scores datasets only");
+    if (rows.features() != w.size())
+        throw runtime_error("predict: input size mismatch");
+    size_t done = 0;
+    batch part;
+    rows.rewind();
+    while (rows.next(part))
+    {
+        if (part.rows > size - done)
+            throw runtime_error("predict: output size mismatch");
+        predict(part, out + done, part.rows);
+        done += part.rows;
+    }
+    if (done != size)
+        throw runtime_error("predict: output size mismatch");
+}
+
+void model::predict(const double *rows, size_t count, size_t stride, double *out, size_t size)
+{
+    if (!categories.empty())
+        throw runtime_error("predict: a model with category features scores datasets only");
+    if (stride < w.size())
+        throw runtime_error("predict: row stride smaller than the feature count");
+    if (size != count)
+        throw runtime_error("predict: output size mismatch");
+
+    const fixed_kernels *f = fixed_kernels_for(w.size());
+    forRanges(count, [&](size_t begin, size_t end)
+              {
+        if (f)
+            f->predictRows(rows + begin * stride, end - begin, stride, w.data(), b, out + begin);
+        else
+            predict_rows(rows + begin * stride, end - begin, w.size(), stride, w.data(), b, out + begin); });
+}
+
 void model::export_to_file(string filename)
 {
+    if (!categories.empty())
+        throw runtime_error("export: category features cannot be exported yet");
     string suffix = ".anouar";
 
     if (!ends_with(filename, suffix))
@@ -119,6 +1249,7 @@ void model::export_to_file(string filename)
     }
 
     ofstream myfile(filename);
+    myfile << setprecision(numeric_limits<double>::max_digits10);
 
     myfile << "I ANOUAR APPROVE THIS FILE!!" << endl;
     myfile << b << "," << endl;
@@ -127,15 +1258,161 @@ void model::export_to_file(string filename)
         myfile << wi << ",";
     }
 
+    // optional transform: its name, then the shift and scale lines
+    if (!scale.empty())
+    {
+        myfile << endl
+               << scaling << "," << endl;
+        for (const double v : shift)
+            myfile << v << ",";
+        myfile << endl;
+        for (const double v : scale)
+            myfile << v << ",";
+    }
+
     myfile.close();
 }
 
+void model::export_binary(string filename)
+{
+    if (!categories.empty())
+        throw runtime_error("export: category features cannot be exported yet");
+    if (!ends_with(filename, ".hsm"))
+        filename += ".hsm";
+
+    string payload;
+    payload.append(reinterpret_cast<const char *>(&b), sizeof(double));
+    payload.append(reinterpret_cast<const char *>(w.data()), w.size() * sizeof(double));
+    // the name table is left empty when the names are unknown
+    for (size_t j = 0; names.size() == w.size() && j < w.size(); j++)
+    {
+        const string &name = names[j];
+        uint32_t length = name.size();
+        payload.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        payload += name;
+    }
+    size_t namesBytes = payload.size() - (w.size() + 1) * sizeof(double);
+    payload.append(reinterpret_cast<const char *>(shift.data()), shift.size() * sizeof(double));
+    payload.append(reinterpret_cast<const char *>(scale.data()), scale.size() * sizeof(double));
+    size_t k = w.size() + 2;
+    for (size_t i = 0; !gram.empty() && i < k; i++)
+        payload.append(reinterpret_cast<const char *>(&gram[i * k + i]), (k - i) * sizeof(double));
+
+    hsm_header h = {};
+    memcpy(h.magic, HSM_MAGIC, sizeof(h.magic));
+    h.version = HSM_VERSION;
+    h.endian = HSM_ENDIAN;
+    h.features = w.size();
+    h.namesBytes = namesBytes;
+    h.flags = scale.empty() ? 0 : (scaling == "standardize" ? 1 : 2);
+    if (!gram.empty())
+        h.flags |= HSM_STATISTICS;
+    h.checksum = fnv1a(payload.data(), payload.size());
+
+    ofstream out(filename, ios::binary | ios::trunc);
+    if (!out.is_open())
+        throw runtime_error("Cannot open file: " + filename);
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.write(payload.data(), payload.size());
+    if (!out)
+        throw runtime_error("Cannot write file: " + filename);
+}
+
+void model::importBinary(const string &filename)
+{
+    mapped_file file(filename);
+    const char *base = file.data();
+    size_t size = file.size();
+
+    hsm_header h;
+    if (size < sizeof(h))
+        throw runtime_error("Truncated model file: " + filename);
+    memcpy(&h, base, sizeof(h));
+    uint64_t transform = h.flags & HSM_TRANSFORM_MASK;
+    bool statistics = h.flags & HSM_STATISTICS;
+    if (h.version < 1 || h.version > HSM_VERSION || transform > 2 || (h.flags & ~(HSM_TRANSFORM_MASK | HSM_STATISTICS)) ||
+        (statistics && h.version < 3))
+        throw runtime_error("Unsupported model version " + to_string(h.version) + ": " + filename);
+    if (h.endian != HSM_ENDIAN)
+        throw runtime_error("Model has foreign byte order: " + filename);
+
+    size_t weights = (h.features + 1) * sizeof(double);
+    if (h.features > size / sizeof(double) || h.namesBytes > size)
+        throw runtime_error("Truncated model file: " + filename);
+    size_t k = h.features + 2;
+    size_t transformBytes = transform ? 2 * h.features * sizeof(double) : 0;
+    size_t statisticsBytes = statistics ? k * (k + 1) / 2 * sizeof(double) : 0;
+    if (sizeof(h) + weights + h.namesBytes + transformBytes + statisticsBytes != size)
+        throw runtime_error("Truncated model file: " + filename);
+    const char *payload = base + sizeof(h);
+    if (fnv1a(payload, size - sizeof(h)) != h.checksum)
+        throw runtime_error("The file is corrupted (checksum mismatch): " + filename);
+
+    memcpy(&b, payload, sizeof(double));
+    w.resize(h.features);
+    memcpy(w.data(), payload + sizeof(double), h.features * sizeof(double));
+
+    names.clear();
+    if (h.namesBytes)
+        names.reserve(h.features);
+    const char *p = payload + weights;
+    const char *end = payload + weights + h.namesBytes;
+    for (uint64_t j = 0; j < h.features && p + sizeof(uint32_t) <= end; j++)
+    {
+        uint32_t length;
+        memcpy(&length, p, sizeof(length));
+        p += sizeof(length);
+        if (length > size_t(end - p))
+            throw runtime_error("Truncated model file: " + filename);
+        names.emplace_back(p, length);
+        p += length;
+    }
+
+    scaling = HSM_TRANSFORMS[transform];
+    shift.clear();
+    scale.clear();
+    if (transform)
+    {
+        shift.resize(h.features);
+        scale.resize(h.features);
+        memcpy(shift.data(), end, h.features * sizeof(double));
+        memcpy(scale.data(), end + h.features * sizeof(double), h.features * sizeof(double));
+    }
+
+    gram.clear();
+    if (statistics)
+    {
+        gram.assign(k * k, 0.0);
+        p = end + transformBytes;
+        for (size_t i = 0; i < k; i++)
+        {
+            memcpy(&gram[i * k + i], p, (k - i) * sizeof(double));
+            p += (k - i) * sizeof(double);
+        }
+    }
+}
+
 void model::import(string filename)
 {
-    ifstream iFile(filename);
+    ifstream iFile(filename, ios::binary);
 
     if (!iFile.is_open())
         throw runtime_error("Cannot open file: " + filename);
+    // the files hold numeric weights only
+    categories.clear();
+    categoryAt.clear();
+    encoding.clear();
+
+    char magic[sizeof(HSM_MAGIC)] = {};
+    iFile.read(magic, sizeof(magic));
+    if (iFile.gcount() == sizeof(magic) && memcmp(magic, HSM_MAGIC, sizeof(magic)) == 0)
+    {
+        iFile.close();
+        importBinary(filename);
+        return;
+    }
+    iFile.clear();
+    iFile.seekg(0);
 
     string line;
     if (!getline(iFile, line))
@@ -146,9 +1423,34 @@ void model::import(string filename)
         throw runtime_error("The file is corrupted or not approved");
     }
 
+    vector<double> bias;
     getline(iFile, line);
+    if (string_to_vector(bias, line, ",", 0) != 1)
+        throw runtime_error("The file is corrupted or not approved");
+    b = bias[0];
 
+    // the text format carries no feature names
+    names.clear();
+    w.clear();
+    getline(iFile, line);
     int weight_count = string_to_vector(w, line, ",", 0);
 
+    scaling = "none";
+    shift.clear();
+    scale.clear();
+    gram.clear();
+    if (getline(iFile, line) && !line.empty())
+    {
+        scaling = line.substr(0, line.find(','));
+        if (scaling != "standardize" && scaling != "minmax")
+            throw runtime_error("The file is corrupted or not approved");
+        getline(iFile, line);
+        string_to_vector(shift, line, ",", 0);
+        getline(iFile, line);
+        string_to_vector(scale, line, ",", 0);
+        if (shift.size() != w.size() || scale.size() != w.size())
+            throw runtime_error("The file is corrupted or not approved");
+    }
+
     cout << weight_count << "WEIGHTS LOADED SUCCESSFULLY !!" << endl;
 }
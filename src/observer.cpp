@@ -0,0 +1,56 @@
+/**
+ * @file observer.cpp
+ * @brief Built-in training telemetry sinks.
+ */
+
+#include "HomemadeScikit/observer.h"
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+log_sink::log_sink(const string &filename, format kind) : file(filename, ios::trunc), out(&file), kind(kind)
+{
+    if (!file.is_open())
+        throw runtime_error("Cannot open file: " + filename);
+    file << setprecision(numeric_limits<double>::max_digits10);
+}
+
+log_sink::log_sink(ostream &out, format kind) : out(&out), kind(kind)
+{
+}
+
+// JSON has no NaN, so a missing value is written as null
+static void json_number(ostream &out, double v)
+{
+    if (isfinite(v))
+        out << v;
+    else
+        out << "null";
+}
+
+void log_sink::onEpoch(const epoch_stats &s)
+{
+    ostream &o = *out;
+    if (kind == CSV)
+    {
+        if (!headerWritten)
+        {
+            o << "epoch,cost,grad_norm,pass_seconds,update_seconds,rows,rows_per_sec\n";
+            headerWritten = true;
+        }
+        o << s.epoch << "," << s.cost << "," << s.gradNorm << "," << s.passSeconds << ","
+          << s.updateSeconds << "," << s.rows << "," << s.rowsPerSec << "\n";
+    }
+    else
+    {
+        o << "{\"epoch\":" << s.epoch << ",\"cost\":";
+        json_number(o, s.cost);
+        o << ",\"grad_norm\":";
+        json_number(o, s.gradNorm);
+        o << ",\"pass_seconds\":" << s.passSeconds << ",\"update_seconds\":" << s.updateSeconds
+          << ",\"rows\":" << s.rows << ",\"rows_per_sec\":";
+        json_number(o, s.rowsPerSec);
+        o << "}\n";
+    }
+}
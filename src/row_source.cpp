@@ -0,0 +1,389 @@
+/**
+ * @file row_source.cpp
+ * @brief Bounded-memory row streaming from CSV and binary datasets.
+ */
+
+#include "HomemadeScikit/row_source.h"
+#include "HomemadeScikit/utils.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+csv_source::csv_source(string f, const vector<variant<string, int>> &x, variant<string, int> y, size_t maxBytes)
+    : filename(f), file(f, ios::binary)
+{
+    if (!file.is_open())
+        throw runtime_error("Cannot open file: " + filename);
+
+    string line;
+    if (!getline(file, line))
+        throw runtime_error("Empty or invalid CSV file: " + filename);
+
+    vector<string> headers;
+    size_t start = 0;
+    size_t end;
+    while ((end = line.find(',', start)) != string::npos)
+    {
+        headers.push_back(line.substr(start, end - start));
+        start = end + 1;
+    }
+    if (start < line.length())
+        headers.push_back(line.substr(start));
+
+    auto resolve = [&](const variant<string, int> &v)
+    {
+        if (const int *ip = get_if<int>(&v))
+            return (*ip >= 0 && *ip < (int)headers.size()) ? *ip : -1;
+        auto it = find(headers.begin(), headers.end(), std::get<string>(v));
+        return it == headers.end() ? -1 : (int)(it - headers.begin());
+    };
+
+    int target = resolve(y);
+    if (target == -1)
+        throw runtime_error("csv_source: unknown target column");
+
+    vector<int> chosen;
+    for (const variant<string, int> &v : x)
+    {
+        int i = resolve(v);
+        if (i == -1 || i == target || find(chosen.begin(), chosen.end(), i) != chosen.end())
+            continue;
+        chosen.push_back(i);
+    }
+    // weights follow dataset::getRow, which lists features in reverse
+    reverse(chosen.begin(), chosen.end());
+
+    nx = chosen.size();
+    slot.assign(headers.size(), -1);
+    for (size_t j = 0; j < nx; j++)
+    {
+        slot[chosen[j]] = j;
+        names.push_back(headers[chosen[j]]);
+    }
+    slot[target] = nx;
+
+    // the read buffer holds a chunk plus the unfinished line before it
+    chunkBytes = min<size_t>(1 << 20, max<size_t>(maxBytes / 4, 256));
+    buffer.reserve(2 * chunkBytes);
+    size_t rowBytes = (nx + 1) * sizeof(double);
+    batchRows = max<size_t>(1, (maxBytes > 2 * chunkBytes ? maxBytes - 2 * chunkBytes : 0) / rowBytes);
+    columns.assign(nx + 1, vector<double>(batchRows));
+
+    peak = 0;
+    rewind();
+}
+
+void csv_source::track()
+{
+    size_t bytes = buffer.capacity() + columns.size() * batchRows * sizeof(double);
+    peak = max(peak, bytes);
+}
+
+void csv_source::rewind()
+{
+    file.clear();
+    file.seekg(0);
+    string header;
+    getline(file, header);
+    buffer.clear();
+    pos = 0;
+    eof = false;
+}
+
+bool csv_source::refill()
+{
+    if (eof)
+        return false;
+    buffer.erase(0, pos);
+    pos = 0;
+    size_t old = buffer.size();
+    buffer.resize(old + chunkBytes);
+    file.read(&buffer[old], chunkBytes);
+    size_t got = file.gcount();
+    buffer.resize(old + got);
+    if (got == 0)
+        eof = true;
+    track();
+    return got > 0;
+}
+
+void csv_source::parseLine(const char *p, const char *end, size_t row)
+{
+    double value;
+    size_t i = 0;
+
+    // short lines leave the remaining columns missing
+    for (vector<double> &c : columns)
+        c[row] = 0.0;
+
+    while (i < slot.size())
+    {
+        const char *comma = static_cast<const char *>(memchr(p, ',', end - p));
+        const char *fieldEnd = comma ? comma : end;
+        int s = slot[i];
+        if (s != -1 && parse_double(p, fieldEnd, value))
+            columns[s][row] = value;
+        i++;
+        if (!comma)
+            break;
+        p = comma + 1;
+    }
+}
+
+bool csv_source::next(batch &out)
+{
+    size_t r = 0;
+    while (r < batchRows)
+    {
+        const char *base = buffer.data();
+        const char *nl = static_cast<const char *>(memchr(base + pos, '\n', buffer.size() - pos));
+        if (!nl)
+        {
+            if (refill())
+                continue;
+            if (pos < buffer.size())
+            {
+                parseLine(buffer.data() + pos, buffer.data() + buffer.size(), r);
+                pos = buffer.size();
+                r++;
+            }
+            break;
+        }
+        parseLine(base + pos, nl, r);
+        pos = nl - base + 1;
+        r++;
+    }
+
+    out.rows = r;
+    out.x.resize(nx);
+    for (size_t j = 0; j < nx; j++)
+        out.x[j] = columns[j].data();
+    out.y = columns[nx].data();
+    return r > 0;
+}
+
+binary_source::binary_source(string filename, const vector<variant<string, int>> &xs, variant<string, int> ys, size_t maxBytes)
+{
+    data.load_binary(filename);
+    if (const int *ip = get_if<int>(&ys))
+        data.chooseY(*ip);
+    else
+        data.chooseY(std::get<string>(ys));
+    if (data.settings.y == -1)
+        throw runtime_error("binary_source: unknown target column");
+    data.chooseX(xs);
+
+    vector<int> chosen = data.settings.x;
+    reverse(chosen.begin(), chosen.end());
+    chosen.push_back(data.settings.y);
+    for (int i : chosen)
+        if (data.data[i].isFloat())
+            throw runtime_error("binary_source: float columns are not supported, load the file as a dataset");
+    chosen.pop_back();
+    for (int i : chosen)
+        x.push_back(data.data[i].data());
+    y = data.data[data.settings.y].data();
+
+    batchRows = max<size_t>(1, maxBytes / ((x.size() + 1) * sizeof(double)));
+    peak = 0;
+    pos = 0;
+}
+
+vector<string> binary_source::featureNames()
+{
+    vector<string> names;
+    for (auto it = data.settings.x.rbegin(); it != data.settings.x.rend(); ++it)
+        names.push_back(data.data[*it].header);
+    return names;
+}
+
+void binary_source::release(size_t begin, size_t end)
+{
+#if !defined(_WIN32)
+    static const uintptr_t page = sysconf(_SC_PAGESIZE);
+    auto drop = [&](const double *p)
+    {
+        uintptr_t from = reinterpret_cast<uintptr_t>(p + begin) & ~(page - 1);
+        uintptr_t to = reinterpret_cast<uintptr_t>(p + end) & ~(page - 1);
+        if (to > from)
+            madvise(reinterpret_cast<void *>(from), to - from, MADV_DONTNEED);
+    };
+    for (const double *p : x)
+        drop(p);
+    drop(y);
+#endif
+}
+
+void binary_source::rewind()
+{
+    release(0, pos);
+    pos = 0;
+}
+
+bool binary_source::next(batch &out)
+{
+    size_t total = data.rows();
+    if (pos > 0)
+        release(pos > batchRows ? pos - batchRows : 0, pos);
+    if (pos >= total)
+        return false;
+
+    size_t r = min(batchRows, total - pos);
+    out.rows = r;
+    out.x.resize(x.size());
+    for (size_t j = 0; j < x.size(); j++)
+        out.x[j] = x[j] + pos;
+    out.y = y + pos;
+    pos += r;
+
+    peak = max(peak, r * (x.size() + 1) * sizeof(double));
+    return true;
+}
+
+async_source::async_source(row_source &source, size_t blocks)
+    : inner(source), nx(source.features()), names(source.featureNames()), ring(max<size_t>(blocks, 2)), head(0),
+      tail(0), finished(false), stopping(false), ringBytes(0), innerPeak(0)
+{
+    start();
+}
+
+async_source::~async_source()
+{
+    stop();
+}
+
+void async_source::start()
+{
+    head = 0;
+    tail = 0;
+    finished = false;
+    stopping = false;
+    error = nullptr;
+    holding = false;
+    reader = thread(&async_source::produce, this);
+}
+
+// polls before a waiting side goes to sleep: a block is usually handed
+// over within a few, while a long parse or training step takes far more
+static const int ASYNC_SPINS = 64;
+
+template <class Ready>
+void async_source::await(Ready ready)
+{
+    for (int i = 0; i < ASYNC_SPINS; i++)
+    {
+        if (ready())
+            return;
+        this_thread::yield();
+    }
+    unique_lock<mutex> guard(sleepers);
+    moved.wait(guard, ready);
+}
+
+void async_source::wake()
+{
+    // taking the lock orders the index store before a sleeper's last check
+    {
+        lock_guard<mutex> guard(sleepers);
+    }
+    moved.notify_all();
+}
+
+void async_source::stop()
+{
+    stopping = true;
+    wake();
+    if (reader.joinable())
+        reader.join();
+}
+
+void async_source::produce()
+{
+    try
+    {
+        batch in;
+        size_t filled = head.load(memory_order_relaxed);
+        while (!stopping.load(memory_order_relaxed))
+        {
+            // wait for the trainer to hand a block back
+            await([&]
+                  { return filled - tail.load(memory_order_acquire) < ring.size() ||
+                           stopping.load(memory_order_relaxed); });
+            if (stopping.load(memory_order_relaxed))
+                break;
+            if (!inner.next(in))
+                break;
+
+            block &b = ring[filled % ring.size()];
+            b.columns.resize(nx + 1);
+            size_t bytes = 0;
+            for (size_t j = 0; j <= nx; j++)
+            {
+                vector<double> &c = b.columns[j];
+                if (c.size() < in.rows)
+                    c.resize(in.rows);
+                copy(j < nx ? in.x[j] : in.y, (j < nx ? in.x[j] : in.y) + in.rows, c.begin());
+            }
+            b.rows = in.rows;
+            for (const block &r : ring)
+                for (const vector<double> &c : r.columns)
+                    bytes += c.capacity() * sizeof(double);
+            ringBytes.store(max(ringBytes.load(memory_order_relaxed), bytes), memory_order_relaxed);
+            innerPeak.store(inner.peakBytes(), memory_order_relaxed);
+
+            head.store(++filled, memory_order_release);
+            wake();
+        }
+    }
+    catch (...)
+    {
+        error = current_exception();
+    }
+    finished.store(true, memory_order_release);
+    wake();
+}
+
+void async_source::rewind()
+{
+    // nothing of this pass taken yet: keep what was read ahead
+    if (tail.load(memory_order_relaxed) == 0 && !holding)
+        return;
+    stop();
+    inner.rewind();
+    start();
+}
+
+bool async_source::next(batch &out)
+{
+    size_t taken = tail.load(memory_order_relaxed);
+    if (holding)
+    {
+        tail.store(++taken, memory_order_release);
+        holding = false;
+        wake();
+    }
+
+    await([&]
+          { return head.load(memory_order_acquire) != taken || finished.load(memory_order_acquire); });
+    // the reader publishes its last block before `finished`
+    if (head.load(memory_order_acquire) == taken)
+    {
+        if (error)
+            rethrow_exception(error);
+        return false;
+    }
+
+    const block &b = ring[taken % ring.size()];
+    holding = true;
+    out.rows = b.rows;
+    out.x.resize(nx);
+    for (size_t j = 0; j < nx; j++)
+        out.x[j] = b.columns[j].data();
+    out.y = b.columns[nx].data();
+    return true;
+}
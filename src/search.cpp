@@ -0,0 +1,162 @@
+/**
+ * @file search.cpp
+ * @brief Cross-validation and grid search over dataset views.
+ */
+
+#include "HomemadeScikit/search.h"
+#include "HomemadeScikit/dataset_view.h"
+#include "HomemadeScikit/thread_pool.h"
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+namespace
+{
+// the lowest cost any candidate has had at each checked epoch of a fold
+class best_curve
+{
+private:
+    mutex lock;
+    vector<double> best;
+
+public:
+    double record(size_t slot, double cost)
+    {
+        lock_guard<mutex> guard(lock);
+        if (best.size() <= slot)
+            best.resize(slot + 1, INFINITY);
+        best[slot] = min(best[slot], cost);
+        return best[slot];
+    }
+};
+
+// cancels a candidate whose cost is hopeless next to the fold's best
+class pruner : public train_observer
+{
+private:
+    best_curve &curve;
+    atomic<bool> &cancel;
+    double prune;
+    int interval;
+
+public:
+    pruner(best_curve &curve, atomic<bool> &cancel, double prune, int interval)
+        : curve(curve), cancel(cancel), prune(prune), interval(interval)
+    {
+    }
+
+    void onEpoch(const epoch_stats &stats) override
+    {
+        if (!isfinite(stats.cost))
+        {
+            cancel = true;
+            return;
+        }
+        if (stats.cost > prune * curve.record(stats.epoch / interval, stats.cost))
+            cancel = true;
+    }
+};
+}
+
+search_report grid_search(dataset &data, const vector<model_settings> &candidates, const search_settings &s)
+{
+    stopwatch started;
+    size_t k = s.folds;
+    size_t c = candidates.size();
+    if (k < 2)
+        throw out_of_range("grid_search: " + to_string(k) + " folds");
+    if (size_t(data.rows()) < k)
+        throw runtime_error("grid_search: fewer rows than folds");
+
+    search_report report;
+    report.candidates.resize(c);
+    for (size_t i = 0; i < c; i++)
+    {
+        report.candidates[i].settings = candidates[i];
+        report.candidates[i].folds.resize(k);
+    }
+
+    vector<atomic<bool>> cancel(c);
+    for (atomic<bool> &flag : cancel)
+        flag = false;
+    vector<best_curve> curves(k);
+    int interval = max(s.interval, 1);
+    thread_pool pool(thread_pool::resolve(s.threads < 0 ? 1 : s.threads));
+
+    // fold-major, so the candidates of a fold run side by side and can
+    // prune each other from their first epochs
+    pool.run(k * c, [&](size_t t)
+             {
+        size_t fold = t / c;
+        size_t i = t % c;
+        fold_result &out = report.candidates[i].folds[fold];
+        if (cancel[i])
+        {
+            out.train.reason = STOP_CANCELLED;
+            return;
+        }
+
+        pair<dataset_view, dataset_view> split = kfold_split(data, k, fold);
+        pruner watch(curves[fold], cancel[i], s.prune, interval);
+        model_settings m = candidates[i];
+        m.pool = &pool;
+        m.cancel = &cancel[i];
+        m.observer = s.prune > 0 ? &watch : nullptr;
+        m.interval = interval;
+
+        model fit(split.first);
+        out.train = fit.train(m);
+        if (out.train.reason != STOP_CANCELLED)
+            out.testCost = fit.calcJ(split.second); });
+
+    double bestCost = INFINITY;
+    report.best = c;
+    for (size_t i = 0; i < c; i++)
+    {
+        cv_report &r = report.candidates[i];
+        for (const fold_result &f : r.folds)
+            r.seconds += f.train.seconds;
+        // a flag raised by a fold's last epoch still voids the candidate
+        r.cancelled = cancel[i];
+        if (r.cancelled)
+        {
+            report.cancelled++;
+            continue;
+        }
+
+        double sum = 0, squares = 0;
+        for (const fold_result &f : r.folds)
+            sum += f.testCost;
+        r.meanCost = sum / k;
+        for (const fold_result &f : r.folds)
+            squares += (f.testCost - r.meanCost) * (f.testCost - r.meanCost);
+        r.stddevCost = sqrt(squares / k);
+        if (r.meanCost < bestCost)
+        {
+            bestCost = r.meanCost;
+            report.best = i;
+        }
+    }
+    report.seconds = started.elapsed();
+    return report;
+}
+
+cv_report cross_validate(dataset &data, const model_settings &m, const search_settings &s)
+{
+    return grid_search(data, {m}, s).candidates[0];
+}
+
+vector<model_settings> parameter_grid(const model_settings &base, const vector<double> &steps,
+                                      const vector<int> &epochs)
+{
+    vector<model_settings> grid;
+    for (int e : epochs)
+        for (double step : steps)
+        {
+            model_settings m = base;
+            m.step = step;
+            m.epochs = e;
+            grid.push_back(m);
+        }
+    return grid;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file simd.cpp
+ * @brief Runtime selection of the vector kernels.
+ */
+
+#include "HomemadeScikit/simd.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+extern const simd_kernels simd_scalar_kernels;
+#if defined(HS_SIMD_X86)
+extern const simd_kernels simd_sse2_kernels;
+extern const simd_kernels simd_avx2_kernels;
+extern const simd_kernels simd_avx512_kernels;
+#endif
+
+static const simd_kernels *table(simd_isa isa)
+{
+    switch (isa)
+    {
+#if defined(HS_SIMD_X86)
+    case simd_isa::sse2:
+        return &simd_sse2_kernels;
+    case simd_isa::avx2:
+        return &simd_avx2_kernels;
+    case simd_isa::avx512:
+        return &simd_avx512_kernels;
+#endif
+    default:
+        return &simd_scalar_kernels;
+    }
+}
+
+bool simd_supported(simd_isa isa)
+{
+    switch (isa)
+    {
+    case simd_isa::scalar:
+        return true;
+#if defined(HS_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    case simd_isa::sse2:
+        return __builtin_cpu_supports("sse2");
+    case simd_isa::avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case simd_isa::avx512:
+        return __builtin_cpu_supports("avx512f");
+#elif defined(HS_SIMD_X86)
+    case simd_isa::sse2:
+        return true; // part of the x86-64 baseline
+#endif
+    default:
+        return false;
+    }
+}
+
+simd_isa simd_detect()
+{
+    for (simd_isa isa : {simd_isa::avx512, simd_isa::avx2, simd_isa::sse2})
+        if (simd_supported(isa))
+            return isa;
+    return simd_isa::scalar;
+}
+
+const char *simd_name(simd_isa isa)
+{
+    switch (isa)
+    {
+    case simd_isa::sse2:
+        return "sse2";
+    case simd_isa::avx2:
+        return "avx2";
+    case simd_isa::avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+static const simd_kernels *initial()
+{
+    simd_isa isa = simd_detect();
+    if (const char *forced = getenv("HS_SIMD"))
+    {
+        for (simd_isa candidate : {simd_isa::scalar, simd_isa::sse2, simd_isa::avx2, simd_isa::avx512})
+            if (strcmp(forced, simd_name(candidate)) == 0 && simd_supported(candidate))
+                isa = candidate;
+    }
+    return table(isa);
+}
+
+static atomic<const simd_kernels *> &active()
+{
+    static atomic<const simd_kernels *> current(initial());
+    return current;
+}
+
+const simd_kernels &simd()
+{
+    return *active().load(memory_order_relaxed);
+}
+
+bool simd_force(simd_isa isa)
+{
+    if (!simd_supported(isa))
+        return false;
+    active().store(table(isa), memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file simd_avx512.cpp
+ * @brief AVX-512F kernels (8 doubles or 16 floats per register, masked tails).
+ *
+ * Built with -mavx512f; only called after CPUID confirmed support.
+ */
+
+#include "HomemadeScikit/simd.h"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+static __mmask8 tail(size_t left)
+{
+    return static_cast<__mmask8>((1u << left) - 1);
+}
+
+static double dot(const double *x, const double *y, size_t n)
+{
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    __m512d s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), s0);
+        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), s1);
+        s2 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 16), _mm512_loadu_pd(y + i + 16), s2);
+        s3 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 24), _mm512_loadu_pd(y + i + 24), s3);
+    }
+    for (; i + 8 <= n; i += 8)
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), s0);
+    if (i < n)
+    {
+        __mmask8 m = tail(n - i);
+        s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, y + i), s1);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3)));
+}
+
+static void axpy(double a, const double *x, double *y, size_t n)
+{
+    __m512d va = _mm512_set1_pd(a);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+    if (i < n)
+    {
+        __mmask8 m = tail(n - i);
+        _mm512_mask_storeu_pd(y + i, m, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, y + i)));
+    }
+}
+
+static void affine(double a, const double *x, double c, double *y, size_t n)
+{
+    __m512d va = _mm512_set1_pd(a), vc = _mm512_set1_pd(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), vc));
+    if (i < n)
+    {
+        __mmask8 m = tail(n - i);
+        _mm512_mask_storeu_pd(y + i, m, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + i), vc));
+    }
+}
+
+static void scale(double a, double *x, size_t n)
+{
+    __m512d va = _mm512_set1_pd(a);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(x + i, _mm512_mul_pd(va, _mm512_loadu_pd(x + i)));
+    if (i < n)
+    {
+        __mmask8 m = tail(n - i);
+        _mm512_mask_storeu_pd(x + i, m, _mm512_mul_pd(va, _mm512_maskz_loadu_pd(m, x + i)));
+    }
+}
+
+static double sum(const double *x, size_t n)
+{
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(x + i));
+        s1 = _mm512_add_pd(s1, _mm512_loadu_pd(x + i + 8));
+    }
+    for (; i + 8 <= n; i += 8)
+        s0 = _mm512_add_pd(s0, _mm512_loadu_pd(x + i));
+    if (i < n)
+        s1 = _mm512_add_pd(s1, _mm512_maskz_loadu_pd(tail(n - i), x + i));
+    return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+static double sum_squares(const double *x, size_t n)
+{
+    return dot(x, x, n);
+}
+
+static __mmask16 tail16(size_t left)
+{
+    return static_cast<__mmask16>((1u << left) - 1);
+}
+
+// the upper 8 floats of a 16-float register (AVX-512F has no direct ps extract)
+static __m256 upper(__m512 v)
+{
+    return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+}
+
+static float dot_f(const float *x, const float *y, size_t n)
+{
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+    __m512 s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64)
+    {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), s1);
+        s2 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 32), _mm512_loadu_ps(y + i + 32), s2);
+        s3 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 48), _mm512_loadu_ps(y + i + 48), s3);
+    }
+    for (; i + 16 <= n; i += 16)
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+    if (i < n)
+    {
+        __mmask16 m = tail16(n - i);
+        s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, x + i), _mm512_maskz_loadu_ps(m, y + i), s1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(s0, s1), _mm512_add_ps(s2, s3)));
+}
+
+static double dot_fd(const float *x, const float *y, size_t n)
+{
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512 vx = _mm512_loadu_ps(x + i), vy = _mm512_loadu_ps(y + i);
+        s0 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(vx)), _mm512_cvtps_pd(_mm512_castps512_ps256(vy)), s0);
+        s1 = _mm512_fmadd_pd(_mm512_cvtps_pd(upper(vx)), _mm512_cvtps_pd(upper(vy)), s1);
+    }
+    if (i < n)
+    {
+        __mmask16 m = tail16(n - i);
+        __m512 vx = _mm512_maskz_loadu_ps(m, x + i), vy = _mm512_maskz_loadu_ps(m, y + i);
+        s0 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(vx)), _mm512_cvtps_pd(_mm512_castps512_ps256(vy)), s0);
+        s1 = _mm512_fmadd_pd(_mm512_cvtps_pd(upper(vx)), _mm512_cvtps_pd(upper(vy)), s1);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+static void axpy_f(float a, const float *x, float *y, size_t n)
+{
+    __m512 va = _mm512_set1_ps(a);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+    if (i < n)
+    {
+        __mmask16 m = tail16(n - i);
+        _mm512_mask_storeu_ps(y + i, m, _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, x + i), _mm512_maskz_loadu_ps(m, y + i)));
+    }
+}
+
+static void affine_f(float a, const float *x, float c, float *y, size_t n)
+{
+    __m512 va = _mm512_set1_ps(a), vc = _mm512_set1_ps(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), vc));
+    if (i < n)
+    {
+        __mmask16 m = tail16(n - i);
+        _mm512_mask_storeu_ps(y + i, m, _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, x + i), vc));
+    }
+}
+
+static float sum_f(const float *x, size_t n)
+{
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        s0 = _mm512_add_ps(s0, _mm512_loadu_ps(x + i));
+        s1 = _mm512_add_ps(s1, _mm512_loadu_ps(x + i + 16));
+    }
+    for (; i + 16 <= n; i += 16)
+        s0 = _mm512_add_ps(s0, _mm512_loadu_ps(x + i));
+    if (i < n)
+        s1 = _mm512_add_ps(s1, _mm512_maskz_loadu_ps(tail16(n - i), x + i));
+    return _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+}
+
+static double sum_fd(const float *x, size_t n)
+{
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512 v = _mm512_loadu_ps(x + i);
+        s0 = _mm512_add_pd(s0, _mm512_cvtps_pd(_mm512_castps512_ps256(v)));
+        s1 = _mm512_add_pd(s1, _mm512_cvtps_pd(upper(v)));
+    }
+    if (i < n)
+    {
+        __m512 v = _mm512_maskz_loadu_ps(tail16(n - i), x + i);
+        s0 = _mm512_add_pd(s0, _mm512_cvtps_pd(_mm512_castps512_ps256(v)));
+        s1 = _mm512_add_pd(s1, _mm512_cvtps_pd(upper(v)));
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+extern const simd_kernels simd_avx512_kernels = {simd_isa::avx512, dot, axpy, affine, scale, sum, sum_squares,
+                                                 dot_f, dot_fd, axpy_f, affine_f, sum_f, sum_fd};
+
+#endif
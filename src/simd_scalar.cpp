@@ -0,0 +1,107 @@
+/**
+ * @file simd_scalar.cpp
+ * @brief Portable fallback kernels.
+ */
+
+#include "HomemadeScikit/simd.h"
+
+static double dot(const double *x, const double *y, size_t n)
+{
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        s0 += x[i] * y[i];
+        s1 += x[i + 1] * y[i + 1];
+        s2 += x[i + 2] * y[i + 2];
+        s3 += x[i + 3] * y[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += x[i] * y[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static void axpy(double a, const double *x, double *y, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        y[i] += a * x[i];
+}
+
+static void affine(double a, const double *x, double c, double *y, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        y[i] = a * x[i] + c;
+}
+
+static void scale(double a, double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        x[i] *= a;
+}
+
+static double sum(const double *x, size_t n)
+{
+    double s0 = 0, s1 = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        s0 += x[i];
+        s1 += x[i + 1];
+    }
+    for (; i < n; i++)
+        s0 += x[i];
+    return s0 + s1;
+}
+
+static double sum_squares(const double *x, size_t n)
+{
+    return dot(x, x, n);
+}
+
+// single precision; Acc is float or double
+template <class Acc>
+static Acc dot_f(const float *x, const float *y, size_t n)
+{
+    Acc s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        s0 += Acc(x[i]) * y[i];
+        s1 += Acc(x[i + 1]) * y[i + 1];
+        s2 += Acc(x[i + 2]) * y[i + 2];
+        s3 += Acc(x[i + 3]) * y[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += Acc(x[i]) * y[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+static void axpy_f(float a, const float *x, float *y, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        y[i] += a * x[i];
+}
+
+static void affine_f(float a, const float *x, float c, float *y, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        y[i] = a * x[i] + c;
+}
+
+template <class Acc>
+static Acc sum_f(const float *x, size_t n)
+{
+    Acc s0 = 0, s1 = 0;
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        s0 += x[i];
+        s1 += x[i + 1];
+    }
+    for (; i < n; i++)
+        s0 += x[i];
+    return s0 + s1;
+}
+
+extern const simd_kernels simd_scalar_kernels = {simd_isa::scalar, dot, axpy, affine, scale, sum, sum_squares,
+                                                 dot_f<float>, dot_f<double>, axpy_f, affine_f, sum_f<float>, sum_f<double>};
@@ -0,0 +1,172 @@
+/**
+ * @file simd_sse2.cpp
+ * @brief SSE2 kernels (2 doubles or 4 floats per register).
+ */
+
+#include "HomemadeScikit/simd.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+
+static double hsum(__m128d v)
+{
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static double dot(const double *x, const double *y, size_t n)
+{
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+    }
+    double s = hsum(_mm_add_pd(s0, s1));
+    for (; i < n; i++)
+        s += x[i] * y[i];
+    return s;
+}
+
+static void axpy(double a, const double *x, double *y, size_t n)
+{
+    __m128d va = _mm_set1_pd(a);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+    for (; i < n; i++)
+        y[i] += a * x[i];
+}
+
+static void affine(double a, const double *x, double c, double *y, size_t n)
+{
+    __m128d va = _mm_set1_pd(a), vc = _mm_set1_pd(c);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_mul_pd(va, _mm_loadu_pd(x + i)), vc));
+    for (; i < n; i++)
+        y[i] = a * x[i] + c;
+}
+
+static void scale(double a, double *x, size_t n)
+{
+    __m128d va = _mm_set1_pd(a);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(x + i, _mm_mul_pd(va, _mm_loadu_pd(x + i)));
+    for (; i < n; i++)
+        x[i] *= a;
+}
+
+static double sum(const double *x, size_t n)
+{
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        s0 = _mm_add_pd(s0, _mm_loadu_pd(x + i));
+        s1 = _mm_add_pd(s1, _mm_loadu_pd(x + i + 2));
+    }
+    double s = hsum(_mm_add_pd(s0, s1));
+    for (; i < n; i++)
+        s += x[i];
+    return s;
+}
+
+static double sum_squares(const double *x, size_t n)
+{
+    return dot(x, x, n);
+}
+
+static float hsum(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 1)));
+}
+
+static float dot_f(const float *x, const float *y, size_t n)
+{
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+    }
+    float s = hsum(_mm_add_ps(s0, s1));
+    for (; i < n; i++)
+        s += x[i] * y[i];
+    return s;
+}
+
+static double dot_fd(const float *x, const float *y, size_t n)
+{
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i);
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_cvtps_pd(vx), _mm_cvtps_pd(vy)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(vx, vx)), _mm_cvtps_pd(_mm_movehl_ps(vy, vy))));
+    }
+    double s = hsum(_mm_add_pd(s0, s1));
+    for (; i < n; i++)
+        s += double(x[i]) * y[i];
+    return s;
+}
+
+static void axpy_f(float a, const float *x, float *y, size_t n)
+{
+    __m128 va = _mm_set1_ps(a);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+    for (; i < n; i++)
+        y[i] += a * x[i];
+}
+
+static void affine_f(float a, const float *x, float c, float *y, size_t n)
+{
+    __m128 va = _mm_set1_ps(a), vc = _mm_set1_ps(c);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(va, _mm_loadu_ps(x + i)), vc));
+    for (; i < n; i++)
+        y[i] = a * x[i] + c;
+}
+
+static float sum_f(const float *x, size_t n)
+{
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        s0 = _mm_add_ps(s0, _mm_loadu_ps(x + i));
+        s1 = _mm_add_ps(s1, _mm_loadu_ps(x + i + 4));
+    }
+    float s = hsum(_mm_add_ps(s0, s1));
+    for (; i < n; i++)
+        s += x[i];
+    return s;
+}
+
+static double sum_fd(const float *x, size_t n)
+{
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(x + i);
+        s0 = _mm_add_pd(s0, _mm_cvtps_pd(v));
+        s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+    double s = hsum(_mm_add_pd(s0, s1));
+    for (; i < n; i++)
+        s += x[i];
+    return s;
+}
+
+extern const simd_kernels simd_sse2_kernels = {simd_isa::sse2, dot, axpy, affine, scale, sum, sum_squares,
+                                               dot_f, dot_fd, axpy_f, affine_f, sum_f, sum_fd};
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Work-stealing worker pool implementation.
+ */
+
+#include "HomemadeScikit/thread_pool.h"
+#include <atomic>
+#include <exception>
+
+namespace
+{
+// the pool the current thread works for, and its deque there
+thread_local const thread_pool *current = nullptr;
+thread_local size_t currentQueue = 0;
+}
+
+size_t thread_pool::resolve(size_t threads)
+{
+    if (threads == 0)
+        threads = thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+thread_pool::thread_pool(size_t threads)
+{
+    stopping = false;
+    threads = resolve(threads);
+    queues.resize(threads);
+    for (size_t i = 1; i < threads; i++)
+        workers.emplace_back(&thread_pool::workerLoop, this, i - 1);
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread &t : workers)
+        t.join();
+}
+
+bool thread_pool::take(size_t self, task &out)
+{
+    // newest of our own first, then the oldest of anyone else's
+    if (!queues[self].empty())
+    {
+        out = move(queues[self].back());
+        queues[self].pop_back();
+        return true;
+    }
+    for (size_t k = 1; k < queues.size(); k++)
+    {
+        deque<task> &victim = queues[(self + k) % queues.size()];
+        if (!victim.empty())
+        {
+            out = move(victim.front());
+            victim.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void thread_pool::workerLoop(size_t self)
+{
+    current = this;
+    currentQueue = self;
+    unique_lock<mutex> guard(lock);
+    while (true)
+    {
+        task next;
+        if (take(self, next))
+        {
+            guard.unlock();
+            next.work();
+            guard.lock();
+            continue;
+        }
+        if (stopping)
+            return;
+        wake.wait(guard);
+    }
+}
+
+void thread_pool::run(size_t count, const function<void(size_t)> &fn)
+{
+    if (count == 0)
+        return;
+
+    atomic<size_t> next(0);
+    size_t done = 0;
+    exception_ptr error;
+    mutex errorLock;
+    condition_variable finished;
+
+    // every participant pulls indices until none are left
+    auto drain = [&]()
+    {
+        size_t i;
+        while ((i = next.fetch_add(1)) < count)
+        {
+            try
+            {
+                fn(i);
+            }
+            catch (...)
+            {
+                lock_guard<mutex> guard(errorLock);
+                if (!error)
+                    error = current_exception();
+            }
+        }
+    };
+
+    size_t self = current == this ? currentQueue : workers.size();
+    size_t helpers = min(workers.size(), count - 1);
+    {
+        lock_guard<mutex> guard(lock);
+        for (size_t h = 0; h < helpers; h++)
+        {
+            queues[self].push_back({[&]()
+                                    {
+                drain();
+                lock_guard<mutex> guard(lock);
+                done++;
+                finished.notify_one(); },
+                                    &next});
+        }
+    }
+    if (helpers)
+        wake.notify_all();
+
+    drain();
+
+    // helpers nobody has started would find no index left: withdraw them
+    // and wait only for the ones already running
+    unique_lock<mutex> guard(lock);
+    deque<task> &mine = queues[self];
+    for (auto it = mine.begin(); it != mine.end();)
+    {
+        if (it->owner == &next)
+        {
+            it = mine.erase(it);
+            done++;
+        }
+        else
+            ++it;
+    }
+    finished.wait(guard, [&] { return done == helpers; });
+    guard.unlock();
+    if (error)
+        rethrow_exception(error);
+}
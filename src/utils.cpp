@@ -4,69 +4,77 @@
 //  - Run it in CUDA for even faster computations
 
 #include "HomemadeScikit/utils.h"
+#include "HomemadeScikit/simd.h"
 #include <cmath>
+#include <charconv>
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
 
 double dot(const vector<double> &v1, const vector<double> &v2)
 {
-    double product = 0;
-    for (int i = 0; i < v1.size(); i++)
-    {
-        product += v1[i] * v2[i];
-    }
-    return product;
-}
-
-vector<double> operator/(const vector<double> &v, double n)
-{
-    vector<double> result(v.size());
-    for (int i = 0; i < v.size(); i++)
-    {
-        result[i] = v[i] / n;
-    }
-    return result;
+    return simd().dot(v1.data(), v2.data(), v1.size());
 }
 
 vector<double> &operator/=(vector<double> &v, double n)
 {
-    for (int i = 0; i < v.size(); i++)
-    {
-        v[i] /= n;
-    }
+    simd().scale(1.0 / n, v.data(), v.size());
     return v;
 }
 
 vector<double> &operator-=(vector<double> &v1, const vector<double> &v2)
 {
-    for (int i = 0; i < v1.size(); i++)
-    {
-        v1[i] -= v2[i];
-    }
+    simd().axpy(-1.0, v2.data(), v1.data(), v1.size());
     return v1;
 }
 
-vector<double> operator-(const vector<double> &v1, const vector<double> &v2)
+vector<double> &operator-=(vector<double> &v, const vec_scale<vec_ref> &e)
 {
-    vector<double> result(v1.size());
-    for (int i = 0; i < v1.size(); i++)
-    {
-        result[i] = v1[i] - v2[i];
-    }
-    return result;
+    simd().axpy(-e.k, e.e.p, v.data(), v.size());
+    return v;
 }
 
-vector<double> operator*(const vector<double> &v, const double n)
+bool parse_double(const char *first, const char *last, double &value)
 {
-    vector<double> result(v.size());
-    for (int i = 0; i < v.size(); i++)
+    // same leniency as stod: leading whitespace, '+', trailing garbage
+    while (first < last && (*first == ' ' || (*first >= '\t' && *first <= '\r')))
+        first++;
+    if (first < last && *first == '+')
     {
-        result[i] = v[i] * n;
+        first++;
+        if (first < last && *first == '-')
+            return false;
     }
-    return result;
+    if (first == last)
+        return false;
+
+    auto result = from_chars(first, last, value);
+    return result.ec == errc();
 }
 
-vector<double> operator*(const double n, const vector<double> &v)
+bool parse_bool(const char *first, const char *last, double &value)
 {
-    return v * n;
+    while (first < last && (*first == ' ' || (*first >= '\t' && *first <= '\r')))
+        first++;
+    while (last > first && (last[-1] == ' ' || (last[-1] >= '\t' && last[-1] <= '\r')))
+        last--;
+    auto is = [&](const char *word)
+    {
+        size_t n = strlen(word);
+        if (size_t(last - first) != n)
+            return false;
+        for (size_t i = 0; i < n; i++)
+            if (tolower(static_cast<unsigned char>(first[i])) != word[i])
+                return false;
+        return true;
+    };
+    if (is("true"))
+        value = 1.0;
+    else if (is("false"))
+        value = 0.0;
+    else
+        return false;
+    return true;
 }
 
 bool ends_with(string m, string s)
@@ -78,13 +86,18 @@ bool ends_with(string m, string s)
 
 int string_to_vector(vector<double> &v, const string &line, const string separator, int start)
 {
-    if (start == line.length())
-        return 0;
-    int comma = line.find(separator, start);
-    if (comma == std::string::npos)
-        return 0;
-    int count = string_to_vector(v, line, separator, comma + 1);
-    long current = stol(line.substr(start, comma));
-    v.push_back(current);
-    return 1 + count;
-}
\ No newline at end of file
+    // appends every separator-terminated field from `start` on, in order
+    int count = 0;
+    size_t pos = start;
+    size_t sep;
+    while (pos < line.length() && (sep = line.find(separator, pos)) != string::npos)
+    {
+        double value;
+        if (!parse_double(line.data() + pos, line.data() + sep, value))
+            throw runtime_error("string_to_vector: invalid number \"" + line.substr(pos, sep - pos) + "\"");
+        v.push_back(value);
+        pos = sep + separator.length();
+        count++;
+    }
+    return count;
+}
@@ -3,12 +3,28 @@
  * @brief Basic tests for dataset functionality
  */
 
+// the asserts are the checks, so keep them in release builds too
+#undef NDEBUG
+
 #include <iostream>
+#include <fstream>
 #include <cassert>
+#include <filesystem>
+#include <cmath>
 #include "HomemadeScikit/dataset.h"
+#include "HomemadeScikit/dataset_view.h"
 
 using namespace std;
 
+// Write `contents` to a scratch file and return its path
+static string write_temp_csv(const string &name, const string &contents)
+{
+    string path = (filesystem::temp_directory_path() / name).string();
+    ofstream out(path);
+    out << contents;
+    return path;
+}
+
 void test_empty_dataset()
 {
     dataset d;
@@ -48,6 +64,378 @@ void test_column_selection()
     }
 }
 
+void test_missing_values()
+{
+    string path = write_temp_csv("hs_test_missing.csv", "a,b,c,d,e\n1,2,3,4\n4,5,6,7\n7,,9,10\nfoo,8,9,11\n");
+    dataset d(path);
+    assert(d.cols() == 5);
+    assert(d.rows() == 4);
+
+    const column &a = d.data[0];
+    assert(a.size() == 4);
+    assert(a.nullCount() == 1);
+    assert(!a.isSet(3) && a.value(3) == 0.0);
+    assert(a.data()[2] == 7.0);
+
+    assert(d.data[1].nullCount() == 1);
+    assert(d.getValue(2, 1) == "x");
+    assert(d.data[4].nullCount() == 4);
+
+    d.chooseX({0, 1}).chooseY(2);
+    vector<double> row = d.getRow(1);
+    assert(row.size() == 2 && row[0] == 5.0 && row[1] == 4.0);
+
+    filesystem::remove(path);
+    cout << "✓ Missing values test passed" << endl;
+}
+
+void test_malformed_cells()
+{
+    // no trailing newline, signs, padding, garbage and overflow
+    string path = write_temp_csv("hs_test_malformed.csv", "x,y,z\n +1.5,-2e3,abc\n3x,1e999,\n,,,9\n7");
+    dataset d(path);
+    assert(d.rows() == 4);
+    assert(d.data[0].value(0) == 1.5 && d.data[1].value(0) == -2000.0);
+    assert(!d.data[2].isSet(0));
+    assert(d.data[0].isSet(1) && d.data[0].value(1) == 3.0);
+    assert(!d.data[1].isSet(1) && !d.data[2].isSet(1));
+    assert(d.data[0].nullCount() == 1 && d.data[2].nullCount() == 4);
+    assert(d.data[0].value(3) == 7.0 && !d.data[1].isSet(3));
+
+    filesystem::remove(path);
+    cout << "✓ Malformed cells test passed" << endl;
+}
+
+void test_parallel_loading()
+{
+    string contents = "a,b,c\n";
+    for (int i = 0; i < 5000; i++)
+    {
+        contents += to_string(i) + ",";
+        if (i % 7)
+            contents += to_string(i * 0.5);
+        contents += (i % 11) ? ",1\n" : ",bad\n";
+    }
+    string path = write_temp_csv("hs_test_parallel.csv", contents);
+
+    dataset serial(path);
+    load_settings load;
+    load.threads = 8;
+    dataset parallel(path, load);
+    assert(parallel.rows() == serial.rows() && parallel.rows() == 5000);
+    for (int c = 0; c < serial.cols(); c++)
+    {
+        assert(parallel.data[c].nullCount() == serial.data[c].nullCount());
+        for (int r = 0; r < serial.rows(); r++)
+            assert(parallel.getValue(r, c) == serial.getValue(r, c));
+    }
+    assert(parallel.data[0].value(4999) == 4999.0);
+
+    filesystem::remove(path);
+    cout << "✓ Parallel loading test passed" << endl;
+}
+
+void test_binary_roundtrip()
+{
+    string path = write_temp_csv("hs_test_binary.csv", "a,b,c\n1,2,\n4,,6\n7,8,9\n");
+    string bin = (filesystem::temp_directory_path() / "hs_test_binary.hsd").string();
+
+    dataset d(path);
+    d.save_binary(bin);
+    dataset b(bin);
+    assert(b.isLoaded());
+    assert(b.cols() == 3 && b.rows() == 3);
+    assert(b.data[1].header == "b" && b.data[1].type == "double");
+    assert(b.data[0].isBorrowed());
+    for (int c = 0; c < 3; c++)
+    {
+        assert(b.data[c].nullCount() == d.data[c].nullCount());
+        for (int r = 0; r < 3; r++)
+            assert(b.getValue(r, c) == d.getValue(r, c));
+    }
+
+    // mutating a borrowed column copies it first
+    b.data[2].setMissing(2);
+    assert(!b.data[2].isBorrowed() && b.data[2].nullCount() == 2);
+
+    // float columns are written at their own width and borrowed back as float
+    load_settings load;
+    load.precision = "float";
+    dataset narrow(path, load);
+    narrow.save_binary(bin);
+    dataset nb(bin);
+    assert(nb.data[0].isFloat() && nb.data[0].isBorrowed() && nb.data[2].type == "float");
+    for (int c = 0; c < 3; c++)
+    {
+        assert(nb.data[c].nullCount() == d.data[c].nullCount());
+        for (int r = 0; r < 3; r++)
+            assert(nb.getValue(r, c) == d.getValue(r, c));
+    }
+
+    // the cache is built beside the CSV and then preferred over it
+    load_settings cached;
+    cached.cache = true;
+    dataset first(path, cached);
+    assert(filesystem::exists(path + ".hsd"));
+    dataset second(path, cached);
+    assert(second.data[0].isBorrowed() && second.getValue(1, 2) == "6.000000");
+
+    // a cache at the wrong precision is rebuilt
+    load_settings floatCache;
+    floatCache.cache = true;
+    floatCache.precision = "float";
+    dataset third(path, floatCache);
+    assert(third.data[0].isFloat());
+
+    filesystem::remove(path + ".hsd");
+    filesystem::remove(bin);
+    filesystem::remove(path);
+    cout << "✓ Binary dataset test passed" << endl;
+}
+
+void test_column_stats()
+{
+    string path = write_temp_csv("hs_test_stats.csv",
+                                 "a,b\n"
+                                 "1e9,4\n"
+                                 "1e9,\n"
+                                 ",5\n"
+                                 "3e9,x\n");
+    dataset d(path);
+
+    const column_stats &a = d.stats("a");
+    assert(a.count == 3 && a.nulls == 1);
+    assert(a.min == 1e9 && a.max == 3e9);
+    assert(fabs(a.mean - 5e9 / 3) < 1e-3);
+    double var = (2 * pow(1e9 - 5e9 / 3, 2) + pow(3e9 - 5e9 / 3, 2)) / 3;
+    assert(fabs(a.variance - var) <= 1e-12 * var);
+
+    column_stats b = d.stats(1);
+    assert(b.count == 2 && b.nulls == 2 && b.mean == 4.5 && b.variance == 0.25);
+
+    // writes drop the cached summary
+    d.data[1].setMissing(0);
+    assert(d.stats(1).count == 1 && d.stats(1).mean == 5);
+    d.data[1].mutableData()[2] = 7;
+    assert(d.stats(1).max == 7);
+
+    // blocks and a long run of nulls merge to the same answer as one sweep
+    column c;
+    for (int i = 0; i < 5000; i++)
+        c.push_back(1000 + i % 7, i % 3 != 0);
+    double sum = 0, sq = 0;
+    size_t n = 0;
+    for (int i = 0; i < 5000; i++)
+        if (i % 3 != 0)
+            sum += 1000 + i % 7, n++;
+    for (int i = 0; i < 5000; i++)
+        if (i % 3 != 0)
+            sq += pow(1000 + i % 7 - sum / n, 2);
+    assert(c.stats().count == n && c.stats().nulls == 5000 - n);
+    assert(fabs(c.stats().mean - sum / n) < 1e-9 && fabs(c.stats().variance - sq / n) < 1e-9);
+
+    bool threw = false;
+    try
+    {
+        d.stats("missing");
+    }
+    catch (const out_of_range &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    filesystem::remove(path);
+    cout << "✓ Column stats test passed" << endl;
+}
+
+void test_dataset_views()
+{
+    string csv = "a,b,y\n";
+    for (int i = 0; i < 10; i++)
+        csv += to_string(i) + "," + (i == 4 ? "" : to_string(10 * i)) + "," + to_string(100 * i) + "\n";
+    string path = write_temp_csv("hs_test_views.csv", csv);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    // a range hands out the parent's own buffers
+    dataset_view range(d, 2, 7);
+    assert(range.rows() == 5 && range.isRanged() && range.parentRow(0) == 2);
+    assert(range.getRow(1) == d.getRow(3));
+    batch part;
+    assert(range.next(part) && part.rows == 5 && !range.next(part));
+    assert(part.x[0] == d.data[1].data() + 2 && part.y == d.data[2].data() + 2);
+    assert(range.peakBytes() == 0);
+
+    // an index list is gathered, missing cells reading 0.0 as in the parent
+    dataset_view picked(d, vector<size_t>{9, 4, 4, 0}, 3);
+    assert(picked.rows() == 4 && !picked.isRanged());
+    picked.rewind();
+    assert(picked.next(part) && part.rows == 3 && part.x[1][0] == 9 && part.x[0][1] == 0.0 && part.y[2] == 400);
+    assert(picked.next(part) && part.rows == 1 && part.y[0] == 0 && !picked.next(part));
+    assert(picked.peakBytes() == 3 * 3 * sizeof(double));
+
+    // k-fold splits partition the rows with two ranges per training view
+    size_t held = 0;
+    for (size_t fold = 0; fold < 3; fold++)
+    {
+        pair<dataset_view, dataset_view> split = kfold_split(d, 3, fold);
+        assert(split.first.rows() + split.second.rows() == 10 && split.first.isRanged());
+        assert(split.second.parentRow(0) == held);
+        held += split.second.rows();
+    }
+    assert(held == 10);
+    pair<dataset_view, dataset_view> shuffled = train_test_split(d, 0.3, 7);
+    assert(shuffled.first.rows() == 7 && shuffled.second.rows() == 3);
+
+    // a view's columns are its own
+    dataset_view narrow(d);
+    narrow.settings.x.clear();
+    narrow.chooseX({"a"});
+    assert(narrow.features() == 1 && d.settings.x.size() == 2 && narrow.featureNames()[0] == "a");
+
+    // float columns are widened through the gather buffer
+    load_settings load;
+    load.precision = "float";
+    dataset f(path, load);
+    f.chooseX({"a", "b"}).chooseY("y");
+    dataset_view wide(f, 2, 7);
+    assert(wide.next(part) && part.rows == 5 && part.x[1][2] == 4 && part.y[0] == 200);
+
+    bool threw = false;
+    try
+    {
+        dataset_view past(d, 5, 11);
+    }
+    catch (const out_of_range &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    filesystem::remove(path);
+    cout << "✓ Dataset views test passed" << endl;
+}
+
+void test_estimated_sizing()
+{
+    // long lines first, so the serial load's size estimate falls short
+    // and has to grow; short lines first, so it overshoots and is trimmed
+    string longFirst = "a,b\n", shortFirst = "a,b\n";
+    for (int i = 0; i < 20000; i++)
+    {
+        string cell = (i % 9 == 0) ? "" : to_string(i);
+        if (i < 2000)
+            longFirst += "1234567.12345678901234567890," + cell + "\n";
+        else
+            longFirst += "1," + cell + "\n";
+        shortFirst += (i < 10000 ? "1," : "1234567.12345678901234567890,") + cell + "\n";
+    }
+
+    for (const string &contents : {longFirst, shortFirst})
+    {
+        string path = write_temp_csv("hs_test_estimate.csv", contents);
+        dataset estimated(path);
+        load_settings load;
+        load.threads = 4;
+        dataset counted(path, load);
+        assert(estimated.rows() == 20000 && counted.rows() == 20000);
+        assert(estimated.data[1].nullCount() == counted.data[1].nullCount());
+        assert(estimated.data[1].nullCount() == 20000 / 9 + 1);
+        for (int r = 0; r < 20000; r += 7)
+            for (int c = 0; c < 2; c++)
+                assert(estimated.getValue(r, c) == counted.getValue(r, c));
+        assert(estimated.stats(1).count == counted.stats(1).count && estimated.stats(1).max == 19999);
+        filesystem::remove(path);
+    }
+
+    // a trimmed column keeps its cells and has no stray bits past the end
+    column c;
+    c.assign(100);
+    for (size_t i = 0; i < 100; i++)
+        c.mutableData()[i] = double(i);
+    c.resize(70);
+    c.resize(130);
+    c.resize(65);
+    assert(c.size() == 65 && c.value(64) == 64.0 && c.validityBits()[1] == 1);
+    c.setMissing(3);
+    assert(c.nullCount() == 1 && c.value(3) == 0.0 && c.stats().count == 64);
+
+    cout << "✓ Estimated sizing test passed" << endl;
+}
+
+void test_type_inference()
+{
+    // city's first half only has lyon and paris, so the later chunks of a
+    // parallel load meet nice first and must be renumbered
+    string contents = "id,city,flag,price,note\n";
+    for (int i = 0; i < 4000; i++)
+    {
+        string city = i % 11 == 0 ? "" : i < 2000 ? (i % 2 ? "paris" : "lyon") : (i % 3 == 0 ? "nice" : i % 3 == 1 ? "lyon" : " paris ");
+        string flag = i % 4 == 0 ? "true" : i % 4 == 1 ? "FALSE" : i % 4 == 2 ? "1" : "0";
+        string note = i == 5 ? "n/a" : to_string(i % 7);
+        contents += to_string(i) + "," + city + "," + flag + "," + to_string(i * 0.25 + 0.1) + "," + note + "\n";
+    }
+    string path = write_temp_csv("hs_test_infer.csv", contents);
+
+    load_settings load;
+    load.infer = true;
+    dataset d(path, load);
+    assert(d.data[0].kind == "int" && d.data[1].kind == "category" && d.data[2].kind == "bool");
+    assert(d.data[3].kind == "double" && d.data[4].kind == "int");
+    const column &city = d.data[1];
+    assert(city.isCategory() && city.type == "category" && !city.data());
+    assert((*city.levels() == vector<string>{"paris", "lyon", "nice"}));
+    assert(city.nullCount() == 4000 / 11 + 1 && !city.isSet(0) && city.value(0) == -1.0);
+    assert(city.value(1) == 0.0 && d.getValue(2, 1) == "lyon" && d.getValue(2003, 1) == "paris");
+    assert(d.data[2].value(0) == 1.0 && d.data[2].value(1) == 0.0 && d.data[2].nullCount() == 0);
+    assert(!d.data[4].isSet(5) && d.data[4].nullCount() == 1);
+
+    load_settings parallelLoad;
+    parallelLoad.threads = 4;
+    parallelLoad.infer = true;
+    dataset parallel(path, parallelLoad);
+    assert(*parallel.data[1].levels() == *city.levels());
+    for (int r = 0; r < 4000; r++)
+        assert(parallel.data[1].value(r) == city.value(r));
+
+    // kinds, levels and codes survive the binary format; precision leaves codes alone
+    string binary = (filesystem::temp_directory_path() / "hs_test_infer.hsd").string();
+    d.save_binary(binary);
+    dataset loaded(binary);
+    for (int c = 0; c < 5; c++)
+        assert(loaded.data[c].kind == d.data[c].kind);
+    assert(loaded.data[1].isBorrowed() && *loaded.data[1].levels() == *city.levels());
+    loaded.setPrecision("float");
+    assert(loaded.data[1].isCategory() && loaded.data[0].isFloat());
+    for (int r = 0; r < 4000; r += 3)
+        assert(loaded.getValue(r, 1) == d.getValue(r, 1));
+
+    // a chosen category column is not streamed as numbers
+    dataset_view view(d);
+    view.chooseX({"city"}).chooseY("price");
+    batch rows;
+    bool threw = false;
+    try
+    {
+        view.next(rows);
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    // without inference the text cells are missing numbers, as before
+    dataset plain(path);
+    assert(plain.data[1].type == "double" && plain.data[1].kind == "double");
+    assert(plain.data[1].nullCount() == 4000 && plain.data[2].nullCount() == 2000);
+
+    filesystem::remove(path);
+    filesystem::remove(binary);
+    cout << "✓ Type inference test passed" << endl;
+}
+
 int main()
 {
     cout << "Running HomemadeScikit tests...\n"
@@ -56,6 +444,14 @@ int main()
     test_empty_dataset();
     test_dataset_loading();
     test_column_selection();
+    test_missing_values();
+    test_malformed_cells();
+    test_parallel_loading();
+    test_estimated_sizing();
+    test_type_inference();
+    test_binary_roundtrip();
+    test_column_stats();
+    test_dataset_views();
 
     cout << "\nAll tests completed!" << endl;
     return 0;
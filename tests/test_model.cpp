@@ -0,0 +1,1208 @@
+/**
+ * @file test_model.cpp
+ * @brief Basic tests for model training
+ */
+
+// the asserts are the checks, so keep them in release builds too
+#undef NDEBUG
+
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <cmath>
+#include <atomic>
+#include <filesystem>
+#include <numeric>
+#include <sstream>
+#include "HomemadeScikit/dataset.h"
+#include "HomemadeScikit/dataset_view.h"
+#include "HomemadeScikit/model.h"
+#include "HomemadeScikit/fixed_model.h"
+#include "HomemadeScikit/search.h"
+#include "HomemadeScikit/simd.h"
+#include "HomemadeScikit/utils.h"
+
+using namespace std;
+
+// y = 2a - 3b + 1 with a few missing cells, written to a scratch file;
+// `first` numbers the rows, so consecutive segments continue the pattern
+static string write_linear_csv(const string &name, int rows, int first = 0)
+{
+    string path = (filesystem::temp_directory_path() / name).string();
+    ofstream out(path);
+    out << "a,b,y\n";
+    for (int i = first; i < first + rows; i++)
+    {
+        double a = (i % 17) / 17.0;
+        double b = (i % 5) / 5.0;
+        if (i % 13 == 0)
+            out << "," << b << "," << (-3 * b + 1) << "\n";
+        else
+            out << a << "," << b << "," << (2 * a - 3 * b + 1) << "\n";
+    }
+    return path;
+}
+
+static bool close_to(double a, double b, double tol = 1e-9)
+{
+    return fabs(a - b) <= tol * (1 + fabs(a) + fabs(b));
+}
+
+void test_streaming_matches_in_memory()
+{
+    string path = write_linear_csv("hs_test_stream.csv", 1000);
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 50;
+    settings.step = 0.1;
+
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+    model inMemory(d);
+    inMemory.train(settings);
+
+    // a tiny ceiling forces many batches per epoch
+    csv_source csv(path, {"a", "b"}, "y", 4096);
+    model streamed(csv);
+    streamed.train(settings);
+    assert(close_to(streamed.getJ(), inMemory.getJ()));
+    assert(streamed.getPeakBytes() <= 4096);
+
+    string bin = path + ".hsd";
+    d.save_binary(bin);
+    binary_source mapped(bin, {"a", "b"}, "y", 1024);
+    model fromBinary(mapped);
+    fromBinary.train(settings);
+    assert(close_to(fromBinary.getJ(), inMemory.getJ()));
+    assert(fromBinary.getPeakBytes() <= 1024);
+
+    vector<double> probe = {0.5, 0.25};
+    assert(close_to(streamed.predict(probe), inMemory.predict(probe)));
+    assert(close_to(fromBinary.predict(probe), inMemory.predict(probe)));
+
+    filesystem::remove(bin);
+    filesystem::remove(path);
+    cout << "✓ Streaming training test passed" << endl;
+}
+
+// yields two batches of one row, then fails
+class failing_source : public row_source
+{
+private:
+    int served = 0;
+    double one = 1;
+
+public:
+    size_t features() override { return 1; }
+    void rewind() override { served = 0; }
+    bool next(batch &out) override
+    {
+        if (served++ == 2)
+            throw runtime_error("failing_source: broken input");
+        out.rows = 1;
+        out.x = {&one};
+        out.y = &one;
+        return true;
+    }
+    size_t peakBytes() override { return 0; }
+    vector<string> featureNames() override { return {"x"}; }
+};
+
+void test_async_source()
+{
+    string path = write_linear_csv("hs_test_async.csv", 3000);
+
+    // read ahead on a thread, the batches and results are those of the source
+    csv_source direct(path, {"a", "b"}, "y", 4096);
+    model serial(direct);
+    model_settings settings;
+    settings.algo = "sgd";
+    settings.epochs = 3;
+    settings.step = 0.05;
+    settings.batch = 64;
+    serial.train(settings);
+
+    for (size_t blocks : {2, 5})
+    {
+        csv_source csv(path, {"a", "b"}, "y", 4096);
+        async_source ahead(csv, blocks);
+        assert(ahead.features() == 2 && ahead.featureNames() == csv.featureNames());
+        model piped(ahead);
+        piped.train(settings);
+        assert(piped.getW() == serial.getW() && piped.getB() == serial.getB() && piped.getJ() == serial.getJ());
+        assert(ahead.peakBytes() > 0);
+
+        // a rewind part-way through a pass starts it over
+        batch part;
+        ahead.rewind();
+        assert(ahead.next(part) && ahead.next(part));
+        ahead.rewind();
+        size_t rows = 0;
+        while (ahead.next(part))
+            rows += part.rows;
+        assert(rows == 3000);
+    }
+
+    // the statistics fill up while the file is still being read
+    csv_source csv(path, {"a", "b"}, "y", 4096);
+    async_source ahead(csv);
+    model fitted;
+    fitted.partial_fit(ahead);
+    assert(fitted.getSeen() == 3000 && close_to(fitted.getW()[0], -3, 1e-6) && close_to(fitted.getB(), 1, 1e-6));
+
+    // the reader's errors reach the trainer
+    failing_source broken;
+    async_source failing(broken);
+    batch part;
+    assert(failing.next(part) && failing.next(part));
+    bool threw = false;
+    try
+    {
+        failing.next(part);
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    filesystem::remove(path);
+    cout << "✓ Async source test passed" << endl;
+}
+
+void test_threaded_training()
+{
+    string path = write_linear_csv("hs_test_threads.csv", 20000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    model serial(d);
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 20;
+    settings.step = 0.1;
+    serial.train(settings);
+
+    double first = 0;
+    for (int run = 0; run < 2; run++)
+    {
+        model parallel(d);
+        model_settings parallelSettings;
+        parallelSettings.algo = "gradient";
+        parallelSettings.epochs = 20;
+        parallelSettings.step = 0.1;
+        parallelSettings.threads = 4;
+        parallel.train(parallelSettings);
+        assert(close_to(parallel.getJ(), serial.getJ()));
+        // same thread count, same bits
+        if (run == 0)
+            first = parallel.getJ();
+        else
+            assert(parallel.getJ() == first);
+    }
+
+    filesystem::remove(path);
+    cout << "✓ Threaded training test passed" << endl;
+}
+
+void test_stochastic_training()
+{
+    string path = write_linear_csv("hs_test_sgd.csv", 5000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    model initial(d);
+    for (string algo : {"minibatch", "sgd"})
+    {
+        model m(d);
+        model_settings settings;
+        settings.algo = algo;
+        settings.epochs = 30;
+        settings.step = algo == "sgd" ? 0.01 : 0.2;
+        settings.batch = 64;
+        settings.seed = 7;
+        m.train(settings);
+        assert(m.getJ() < initial.getJ() / 10);
+
+        // the seed fixes the visiting order
+        model again(d);
+        again.train(settings);
+        assert(again.getJ() == m.getJ());
+    }
+
+    filesystem::remove(path);
+    cout << "✓ Stochastic training test passed" << endl;
+}
+
+void test_closed_form()
+{
+    string path = write_linear_csv("hs_test_normal.csv", 20000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    // a long gradient run approaches the optimum both solvers land on
+    model gd(d);
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 5000;
+    settings.step = 0.5;
+    gd.train(settings);
+
+    for (string algo : {"normal", "qr"})
+    {
+        for (int threads : {1, 4})
+        {
+            model m(d);
+            model_settings solver;
+            solver.algo = algo;
+            solver.threads = threads;
+            m.train(solver);
+            assert(m.getJ() <= gd.getJ() * (1 + 1e-6));
+            assert(close_to(m.predict({0.3, 0.6}), gd.predict({0.3, 0.6}), 1e-4));
+        }
+    }
+
+    // a duplicated feature breaks Cholesky but not QR
+    d.chooseX({"a"});
+    model normal(d);
+    bool threw = false;
+    try
+    {
+        model_settings normalSettings;
+        normalSettings.algo = "normal";
+        normal.train(normalSettings);
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+    model qr(d);
+    model_settings qrSettings;
+    qrSettings.algo = "qr";
+    qr.train(qrSettings);
+    assert(close_to(qr.getJ(), gd.getJ(), 1e-4));
+
+    filesystem::remove(path);
+    cout << "✓ Closed-form solvers test passed" << endl;
+}
+
+void test_batch_prediction()
+{
+    string path = write_linear_csv("hs_test_predict.csv", 10000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+    model m(d);
+    model_settings settings;
+    settings.algo = "normal";
+    settings.threads = 4;
+    m.train(settings);
+
+    vector<double> byDataset(d.rows());
+    m.predict(d, byDataset.data(), byDataset.size());
+
+    // the same rows as a strided row-major buffer with one padding slot
+    vector<double> rowMajor;
+    for (int i = 0; i < d.rows(); i++)
+    {
+        vector<double> row = d.getRow(i);
+        rowMajor.insert(rowMajor.end(), row.begin(), row.end());
+        rowMajor.push_back(-1);
+    }
+    vector<double> byRows(d.rows());
+    m.predict(rowMajor.data(), d.rows(), 3, byRows.data(), byRows.size());
+
+    for (int i = 0; i < d.rows(); i++)
+    {
+        double expected = m.predict(d.getRow(i));
+        assert(close_to(byDataset[i], expected, 1e-12));
+        assert(close_to(byRows[i], expected, 1e-12));
+    }
+
+    bool threw = false;
+    try
+    {
+        m.predict(d, byDataset.data(), byDataset.size() - 1);
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    filesystem::remove(path);
+    cout << "✓ Batch prediction test passed" << endl;
+}
+
+void test_simd_kernels()
+{
+    // odd lengths exercise every vector body and tail
+    for (size_t n : {0, 1, 3, 7, 17, 64, 1023})
+    {
+        vector<double> x(n), y(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            x[i] = 0.5 + (i % 7) * 0.25;
+            y[i] = 1.0 - (i % 3) * 0.5;
+        }
+
+        vector<float> xf(x.begin(), x.end()), yf(y.begin(), y.end());
+
+        simd_force(simd_isa::scalar);
+        double dot = simd().dot(x.data(), y.data(), n);
+        double sum = simd().sum(x.data(), n);
+        vector<double> axpy = y;
+        simd().axpy(2.0, x.data(), axpy.data(), n);
+
+        for (simd_isa isa : {simd_isa::sse2, simd_isa::avx2, simd_isa::avx512})
+        {
+            if (!simd_force(isa))
+                continue;
+            const simd_kernels &k = simd();
+            assert(k.isa == isa);
+            assert(close_to(k.dot(x.data(), y.data(), n), dot, 1e-12));
+            assert(close_to(k.sum(x.data(), n), sum, 1e-12));
+            assert(close_to(k.sum_squares(x.data(), n), x.empty() ? 0.0 : inner_product(x.begin(), x.end(), x.begin(), 0.0), 1e-12));
+
+            vector<double> v = y;
+            k.axpy(2.0, x.data(), v.data(), n);
+            for (size_t i = 0; i < n; i++)
+                assert(v[i] == axpy[i]);
+
+            k.affine(-1.0, x.data(), 3.0, v.data(), n);
+            k.scale(2.0, v.data(), n);
+            for (size_t i = 0; i < n; i++)
+                assert(v[i] == 2.0 * (3.0 - x[i]));
+
+            // the inputs are exact in float, so widened sums match the double ones
+            assert(close_to(k.dot_fd(xf.data(), yf.data(), n), dot, 1e-12));
+            assert(close_to(k.sum_fd(xf.data(), n), sum, 1e-12));
+            assert(close_to(k.dot_f(xf.data(), yf.data(), n), dot, 1e-6));
+            assert(close_to(k.sum_f(xf.data(), n), sum, 1e-6));
+
+            vector<float> f = yf;
+            k.axpy_f(2.0f, xf.data(), f.data(), n);
+            for (size_t i = 0; i < n; i++)
+                assert(f[i] == float(axpy[i]));
+            k.affine_f(-1.0f, xf.data(), 3.0f, f.data(), n);
+            for (size_t i = 0; i < n; i++)
+                assert(f[i] == 3.0f - xf[i]);
+        }
+    }
+    simd_force(simd_detect());
+    cout << "✓ SIMD kernels test passed (best: " << simd_name(simd_detect()) << ")" << endl;
+}
+
+void test_float_precision()
+{
+    string path = write_linear_csv("hs_test_float.csv", 10000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+    load_settings load;
+    load.precision = "float";
+    dataset f(path, load);
+    f.chooseX({"a", "b"}).chooseY("y");
+    assert(f.data[0].isFloat() && f.data[0].type == "float" && f.data[0].data() == nullptr);
+    assert(f.data[0].nullCount() == d.data[0].nullCount());
+
+    // the float kernels land where the double ones do, to float accuracy
+    for (string algo : {"gradient", "minibatch", "qr"})
+    {
+        for (bool wide : {true, false})
+        {
+            model_settings s;
+            s.algo = algo;
+            s.epochs = 50;
+            s.step = 0.5;
+            s.threads = 2;
+            s.batch = 64;
+            s.seed = 3;
+            s.wideSums = wide;
+            model md(d), mf(f);
+            md.train(s);
+            mf.train(s);
+            assert(close_to(mf.getJ(), md.getJ(), 1e-3) || fabs(mf.getJ() - md.getJ()) < 1e-5);
+            assert(close_to(mf.predict({0.3, 0.6}), md.predict({0.3, 0.6}), 1e-4));
+
+            vector<double> pd(d.rows()), pf(f.rows());
+            md.predict(d, pd.data(), pd.size());
+            mf.predict(f, pf.data(), pf.size());
+            for (size_t i = 0; i < pd.size(); i += 97)
+                assert(fabs(pd[i] - pf[i]) < 1e-3);
+        }
+    }
+
+    // a model needs every chosen column at the same precision
+    dataset mixed(path);
+    mixed.chooseX({"a", "b"}).chooseY("y");
+    mixed.data[0].narrow();
+    bool threw = false;
+    try
+    {
+        model m(mixed);
+        model_settings settings;
+        settings.epochs = 1;
+        m.train(settings);
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    f.setPrecision("double");
+    assert(!f.data[0].isFloat() && f.data[0].data() != nullptr);
+
+    filesystem::remove(path);
+    cout << "✓ Float precision test passed" << endl;
+}
+
+void test_fixed_model()
+{
+    string path = write_linear_csv("hs_test_fixed.csv", 3000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    assert(!fixed_kernels_for(0) && !fixed_kernels_for(FIXED_MAX_FEATURES + 1));
+    assert(fixed_kernels_for(FIXED_MAX_FEATURES)->features == FIXED_MAX_FEATURES);
+
+    // the unrolled SGD step does the generic arithmetic in the same order
+    for (string scaling : {"none", "standardize"})
+    {
+        model_settings s;
+        s.algo = "sgd";
+        s.epochs = 5;
+        s.step = 0.01;
+        s.batch = 64;
+        s.seed = 5;
+        s.scale = scaling;
+        model fast(d), slow(d);
+        fast.train(s);
+        s.specialize = false;
+        slow.train(s);
+        assert(fast.getW() == slow.getW() && fast.getB() == slow.getB());
+    }
+
+    // small minibatch blocks take the unrolled gradient, summed in another order
+    model_settings s;
+    s.algo = "minibatch";
+    s.epochs = 20;
+    s.step = 0.2;
+    s.batch = 16;
+    s.seed = 5;
+    model fast(d), slow(d);
+    fast.train(s);
+    s.specialize = false;
+    slow.train(s);
+    assert(close_to(fast.getJ(), slow.getJ(), 1e-9));
+
+    fixed_model<2> f(fast);
+    assert(f.getB() == fast.getB() && f.getW()[1] == fast.getW()[1]);
+    assert(f.predict({0.3, 0.6}) == fast.predict({0.3, 0.6}));
+
+    vector<double> rows = {0.1, 0.2, 9, 0.4, 0.5, 9, 0.7, 0.8, 9};
+    vector<double> a(3), b(3);
+    f.predict(rows.data(), 3, 3, a.data(), a.size());
+    fast.predict(rows.data(), 3, 3, b.data(), b.size());
+    for (size_t i = 0; i < 3; i++)
+        assert(a[i] == b[i] && close_to(a[i], fast.getB() + rows[3 * i] * fast.getW()[0] + rows[3 * i + 1] * fast.getW()[1]));
+
+    vector<double> pd(d.rows()), pf(d.rows());
+    batch columns;
+    columns.rows = d.rows();
+    columns.x = {d.data[1].data(), d.data[0].data()};
+    f.predict(columns, pf.data(), pf.size());
+    fast.predict(d, pd.data(), pd.size());
+    assert(pd == pf);
+
+    bool threw = false;
+    try
+    {
+        fixed_model<3> wrong(fast);
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    filesystem::remove(path);
+    cout << "✓ Fixed-width model test passed" << endl;
+}
+
+void test_vector_expressions()
+{
+    vector<double> a = {1, 2, 3};
+    vector<double> b = {4, 5, 6};
+
+    // call sites that used to get temporaries still get vectors
+    vector<double> c = a * 2.0;
+    vector<double> d = b - a;
+    vector<double> e = 0.5 * (b - a * 2.0) / 2.0;
+    assert(c == vector<double>({2, 4, 6}));
+    assert(d == vector<double>({3, 3, 3}));
+    assert(e == vector<double>({0.5, 0.25, 0.0}));
+
+    // compound updates evaluate in place
+    vector<double> w = b;
+    w -= 0.5 * a;
+    assert(w == vector<double>({3.5, 4, 4.5}));
+    w -= (b - a) / 3.0;
+    assert(w == vector<double>({2.5, 3, 3.5}));
+    w -= a;
+    assert(w == vector<double>({1.5, 1, 0.5}));
+
+    cout << "✓ Vector expressions test passed" << endl;
+}
+
+// keeps every record it is handed
+class recorder : public train_observer
+{
+public:
+    vector<epoch_stats> seen;
+    void onEpoch(const epoch_stats &stats) override { seen.push_back(stats); }
+};
+
+void test_telemetry()
+{
+    string path = write_linear_csv("hs_test_telemetry.csv", 3000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    // observing does not change the result
+    model quiet(d);
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 50;
+    settings.step = 0.5;
+    quiet.train(settings);
+    recorder r;
+    model watched(d);
+    model_settings watchedSettings;
+    watchedSettings.algo = "gradient";
+    watchedSettings.epochs = 50;
+    watchedSettings.step = 0.5;
+    watchedSettings.observer = &r;
+    watchedSettings.interval = 10;
+    watched.train(watchedSettings);
+    assert(watched.getW() == quiet.getW() && watched.getJ() == quiet.getJ());
+
+    assert(r.seen.size() == 5);
+    for (size_t i = 0; i < r.seen.size(); i++)
+    {
+        const epoch_stats &s = r.seen[i];
+        assert(s.epoch == int(10 * i));
+        assert(s.rows == 3000 && s.passSeconds >= 0 && s.updateSeconds >= 0);
+        assert(isfinite(s.gradNorm) && s.gradNorm > 0);
+        if (i > 0)
+            assert(s.cost < r.seen[i - 1].cost);
+    }
+
+    // the stochastic paths have no full gradient to report
+    recorder sgd;
+    model m(d);
+    model_settings sgdSettings;
+    sgdSettings.algo = "sgd";
+    sgdSettings.epochs = 3;
+    sgdSettings.step = 0.01;
+    sgdSettings.observer = &sgd;
+    m.train(sgdSettings);
+    assert(sgd.seen.size() == 3 && isnan(sgd.seen[0].gradNorm));
+
+    // built-in sinks: CSV with a header, JSON lines with null for NaN
+    stringstream csv, jsonl;
+    log_sink csvSink(csv), jsonSink(jsonl, log_sink::JSONL);
+    model_settings csvSettings;
+    csvSettings.algo = "gradient";
+    csvSettings.epochs = 2;
+    csvSettings.step = 0.5;
+    csvSettings.observer = &csvSink;
+    m.train(csvSettings);
+    model_settings jsonSettings;
+    jsonSettings.algo = "qr";
+    jsonSettings.observer = &jsonSink;
+    m.train(jsonSettings);
+
+    string line;
+    getline(csv, line);
+    assert(line == "epoch,cost,grad_norm,pass_seconds,update_seconds,rows,rows_per_sec");
+    int lines = 0;
+    while (getline(csv, line))
+        lines++;
+    assert(lines == 2);
+    getline(jsonl, line);
+    assert(line.rfind("{\"epoch\":0,\"cost\":", 0) == 0);
+    assert(line.find("\"grad_norm\":null") != string::npos);
+
+    filesystem::remove(path);
+    cout << "✓ Telemetry test passed" << endl;
+}
+
+void test_early_stopping()
+{
+    string path = write_linear_csv("hs_test_stopping.csv", 3000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    model full(d);
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 300;
+    settings.step = 0.5;
+    train_report r = full.train(settings);
+    assert(r.reason == STOP_EPOCHS && r.epochs == 300 && r.cost == full.getJ());
+
+    // a plateau ends training early
+    model plateau(d);
+    model_settings plateauSettings;
+    plateauSettings.algo = "gradient";
+    plateauSettings.epochs = 100000;
+    plateauSettings.step = 0.5;
+    plateauSettings.tolerance = 1e-6;
+    plateauSettings.patience = 3;
+    r = plateau.train(plateauSettings);
+    assert(r.reason == STOP_COST && r.epochs < 100000);
+    assert(string(stop_reason_name(r.reason)) == "cost");
+
+    model flat(d);
+    model_settings flatSettings;
+    flatSettings.algo = "gradient";
+    flatSettings.epochs = 100000;
+    flatSettings.step = 0.5;
+    flatSettings.gradTolerance = 1e-4;
+    r = flat.train(flatSettings);
+    assert(r.reason == STOP_GRADIENT && r.epochs < 100000);
+    assert(flat.getJ() < 1e-6);
+    assert(flat.getReport().epochs == r.epochs);
+
+    model timed(d);
+    model_settings timedSettings;
+    timedSettings.algo = "sgd";
+    timedSettings.epochs = 1000000;
+    timedSettings.step = 0.01;
+    timedSettings.timeLimit = 0.05;
+    r = timed.train(timedSettings);
+    assert(r.reason == STOP_TIME && r.epochs < 1000000 && r.seconds >= 0.05);
+
+    model solved(d);
+    model_settings solvedSettings;
+    solvedSettings.algo = "qr";
+    r = solved.train(solvedSettings);
+    assert(r.reason == STOP_SOLVED && r.epochs == 1);
+
+    // an unknown algo is refused rather than reported as trained
+    model_settings bogus;
+    bogus.algo = "newton";
+    bool threw = false;
+    try
+    {
+        solved.train(bogus);
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    filesystem::remove(path);
+    cout << "✓ Early stopping test passed (plateau after " << plateau.getReport().epochs << " epochs)" << endl;
+}
+
+void test_feature_scaling()
+{
+    // features with large offsets and very different ranges
+    string path = (filesystem::temp_directory_path() / "hs_test_scaling.csv").string();
+    {
+        ofstream out(path);
+        out << "a,b,y\n";
+        for (int i = 0; i < 2000; i++)
+        {
+            double a = 5000 + (i % 17) * 10.0;
+            double b = 0.001 * (i % 5);
+            out << a << "," << b << "," << (0.02 * a - 300 * b + 1) << "\n";
+        }
+    }
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    model raw(d);
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 500;
+    settings.step = 1e-8;
+    raw.train(settings);
+
+    for (string kind : {"standardize", "minmax"})
+    {
+        model scaled(d);
+        model_settings scaledSettings;
+        scaledSettings.algo = "gradient";
+        scaledSettings.epochs = 500;
+        scaledSettings.step = kind == "minmax" ? 0.5 : 0.3;
+        scaledSettings.scale = kind;
+        scaled.train(scaledSettings);
+        assert(scaled.getScaling() == kind && scaled.getScale().size() == 2);
+        assert(scaled.getJ() < 1e-6 && scaled.getJ() < raw.getJ() * 1e-3);
+        // predictions take raw features
+        assert(close_to(scaled.predict({0.002, 5050}), 0.02 * 5050 - 300 * 0.002 + 1, 1e-3));
+
+        model sgd(d);
+        model_settings sgdSettings;
+        sgdSettings.algo = "minibatch";
+        sgdSettings.epochs = 50;
+        sgdSettings.step = 0.1;
+        sgdSettings.batch = 64;
+        sgdSettings.scale = kind;
+        sgd.train(sgdSettings);
+        assert(sgd.getJ() < 1e-3);
+    }
+
+    // the transform survives both file formats
+    model m(d);
+    model_settings mSettings;
+    mSettings.algo = "gradient";
+    mSettings.epochs = 10;
+    mSettings.step = 0.3;
+    mSettings.scale = "standardize";
+    m.train(mSettings);
+    string bin = (filesystem::temp_directory_path() / "hs_test_scaled").string();
+    string text = bin + ".anouar";
+    m.export_binary(bin);
+    m.export_to_file(text);
+    for (string file : {bin + ".hsm", text})
+    {
+        model loaded;
+        loaded.import(file);
+        assert(loaded.getScaling() == "standardize");
+        assert(loaded.getShift() == m.getShift() && loaded.getScale() == m.getScale());
+        assert(loaded.predict({0.002, 5050}) == m.predict({0.002, 5050}));
+    }
+
+    // an unknown transform name is refused
+    stringstream contents;
+    contents << ifstream(text).rdbuf();
+    string edited = contents.str();
+    edited.replace(edited.find("standardize"), 11, "logarithm");
+    ofstream(text) << edited;
+    bool threw = false;
+    try
+    {
+        model loaded;
+        loaded.import(text);
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    filesystem::remove(path);
+    filesystem::remove(bin + ".hsm");
+    filesystem::remove(text);
+    cout << "✓ Feature scaling test passed" << endl;
+}
+
+void test_model_files()
+{
+    string path = write_linear_csv("hs_test_export.csv", 2000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    model m(d);
+    model_settings settings;
+    settings.algo = "qr";
+    m.train(settings);
+    assert(m.getNames() == vector<string>({"b", "a"}));
+
+    // binary roundtrip is bit-exact and keeps the feature names
+    string bin = (filesystem::temp_directory_path() / "hs_test_model").string();
+    m.export_binary(bin);
+    model loaded;
+    loaded.import(bin + ".hsm");
+    assert(loaded.getW() == m.getW());
+    assert(loaded.getB() == m.getB());
+    assert(loaded.getNames() == m.getNames());
+
+    // the text format restores the bias and fractional weights too
+    string text = (filesystem::temp_directory_path() / "hs_test_model.anouar").string();
+    m.export_to_file(text);
+    model fromText;
+    fromText.import(text);
+    assert(fromText.getW() == m.getW());
+    assert(fromText.getB() == m.getB());
+    assert(fromText.predict({0.3, 0.6}) == m.predict({0.3, 0.6}));
+    model over(d);
+    over.import(text);
+    assert(over.getNames().empty());
+
+    // a flipped payload byte is caught by the checksum
+    {
+        fstream f(bin + ".hsm", ios::in | ios::out | ios::binary);
+        f.seekp(48);
+        f.put('\x7f');
+    }
+    bool threw = false;
+    try
+    {
+        model corrupt;
+        corrupt.import(bin + ".hsm");
+    }
+    catch (const runtime_error &)
+    {
+        threw = true;
+    }
+    assert(threw);
+
+    filesystem::remove(path);
+    filesystem::remove(bin + ".hsm");
+    filesystem::remove(text);
+    cout << "✓ Model files test passed" << endl;
+}
+
+void test_partial_fit()
+{
+    // noise keeps the fit from being exact, so the costs are comparable
+    auto noisy = [](const string &name, int rows, int first)
+    {
+        string path = (filesystem::temp_directory_path() / name).string();
+        ofstream out(path);
+        out << "a,b,y\n";
+        for (int i = first; i < first + rows; i++)
+        {
+            double a = (i % 17) / 17.0, b = (i % 5) / 5.0;
+            out << a << "," << b << "," << (2 * a - 3 * b + 1 + ((i * 7919) % 11 - 5) * 0.01) << "\n";
+        }
+        return path;
+    };
+    vector<string> segments;
+    for (int s = 0; s < 4; s++)
+        segments.push_back(noisy("hs_test_partial" + to_string(s) + ".csv", 1000, s * 1000));
+    string all = noisy("hs_test_partial_all.csv", 3000, 0);
+
+    // three hourly deltas fitted one at a time land on the full fit
+    model m;
+    for (int s = 0; s < 3; s++)
+    {
+        dataset delta(segments[s]);
+        delta.chooseX({"a", "b"}).chooseY("y");
+        train_report r = m.partial_fit(delta);
+        assert(r.reason == STOP_SOLVED && m.getSeen() == size_t(1000 * (s + 1)));
+    }
+    dataset full(all);
+    full.chooseX({"a", "b"}).chooseY("y");
+    model once(full);
+    model_settings settings;
+    settings.algo = "normal";
+    once.train(settings);
+    assert(close_to(m.getW()[0], once.getW()[0]) && close_to(m.getW()[1], once.getW()[1]));
+    assert(close_to(m.getB(), once.getB()) && close_to(m.getJ(), once.getJ(), 1e-6));
+    assert(m.getNames() == once.getNames());
+
+    // the statistics travel with the binary model, and a QR fit leaves them too
+    string file = (filesystem::temp_directory_path() / "hs_test_partial").string();
+    m.export_binary(file);
+    model served;
+    served.import(file + ".hsm");
+    assert(served.getSeen() == 3000);
+    model qr(full);
+    model_settings qrSettings;
+    qrSettings.algo = "qr";
+    qr.train(qrSettings);
+    assert(qr.getSeen() == 3000);
+
+    csv_source delta(segments[3], {"a", "b"}, "y");
+    served.partial_fit(delta);
+    qr.partial_fit(delta);
+    string four = noisy("hs_test_partial_four.csv", 4000, 0);
+    dataset whole(four);
+    whole.chooseX({"a", "b"}).chooseY("y");
+    model reference(whole);
+    reference.train(settings);
+    for (model *fitted : {&served, &qr})
+    {
+        assert(fitted->getSeen() == 4000);
+        assert(close_to(fitted->getW()[0], reference.getW()[0], 1e-8));
+        assert(close_to(fitted->getB(), reference.getB(), 1e-8));
+    }
+
+    // a warm start from the statistics alone approaches the same optimum
+    model warm;
+    dataset first(segments[0]);
+    first.chooseX({"a", "b"}).chooseY("y");
+    model_settings warmSettings;
+    warmSettings.algo = "gradient";
+    warmSettings.epochs = 2000;
+    warmSettings.step = 0.5;
+    warmSettings.tolerance = 1e-12;
+    warmSettings.scale = "standardize";
+    train_report r = warm.partial_fit(first, warmSettings);
+    model exact;
+    exact.partial_fit(first);
+    assert(r.reason == STOP_COST && close_to(warm.getJ(), exact.getJ(), 1e-4));
+
+    // a single row cannot pin down two weights yet, and minmax has no statistics
+    batch one;
+    double x0 = 1, x1 = 2, y = 3;
+    one.rows = 1;
+    one.x = {&x0, &x1};
+    one.y = &y;
+    int threw = 0;
+    try
+    {
+        model fresh;
+        fresh.partial_fit(one);
+    }
+    catch (const runtime_error &)
+    {
+        threw++;
+    }
+    try
+    {
+        model_settings minmax;
+        minmax.algo = "gradient";
+        minmax.scale = "minmax";
+        warm.partial_fit(first, minmax);
+    }
+    catch (const runtime_error &)
+    {
+        threw++;
+    }
+    try
+    {
+        one.x.pop_back();
+        warm.partial_fit(one);
+    }
+    catch (const runtime_error &)
+    {
+        threw++;
+    }
+    assert(threw == 3);
+
+    for (const string &path : segments)
+        filesystem::remove(path);
+    filesystem::remove(all);
+    filesystem::remove(four);
+    filesystem::remove(file + ".hsm");
+    cout << "✓ Partial fit test passed" << endl;
+}
+
+void test_view_training()
+{
+    string path = write_linear_csv("hs_test_view.csv", 4000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    // a view of every row trains exactly like the dataset, ranged or gathered
+    model whole(d);
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 20;
+    settings.step = 0.5;
+    whole.train(settings);
+    dataset_view all(d);
+    vector<size_t> every(d.rows());
+    iota(every.begin(), every.end(), 0);
+    dataset_view listed(d, every);
+    for (dataset_view *v : {&all, &listed})
+    {
+        model m(*v);
+        m.train(settings);
+        assert(m.getJ() == whole.getJ() && m.getW() == whole.getW());
+    }
+
+    // held-out rows are scored straight from the parent's buffers
+    pair<dataset_view, dataset_view> split = kfold_split(d, 4, 1);
+    model m(split.first);
+    model_settings mSettings;
+    mSettings.algo = "qr";
+    m.train(mSettings);
+    vector<double> out(split.second.rows());
+    m.predict(split.second, out.data(), out.size());
+    for (size_t i = 0; i < out.size(); i += 37)
+        assert(close_to(out[i], m.predict(split.second.getRow(i))));
+
+    // the held-out cost leaves the training cost alone
+    double training = m.getJ();
+    assert(m.calcJ(split.second) < 1e-10 && m.getJ() == training);
+
+    filesystem::remove(path);
+    cout << "✓ View training test passed" << endl;
+}
+
+void test_grid_search()
+{
+    // a run() nested in a task neither deadlocks nor loses work
+    thread_pool pool(4);
+    atomic<size_t> calls(0);
+    pool.run(8, [&](size_t)
+             { pool.run(16, [&](size_t)
+                        { calls++; }); });
+    assert(calls == 8 * 16);
+
+    string path = write_linear_csv("hs_test_search.csv", 4000);
+    dataset d(path);
+    d.chooseX({"a", "b"}).chooseY("y");
+
+    // every fold matches a model trained alone on the same split
+    model_settings settings;
+    settings.algo = "gradient";
+    settings.epochs = 200;
+    settings.step = 0.5;
+    search_settings search;
+    search.folds = 4;
+    search.threads = 4;
+    cv_report cv = cross_validate(d, settings, search);
+    assert(cv.folds.size() == 4 && !cv.cancelled);
+    double sum = 0;
+    for (size_t f = 0; f < 4; f++)
+    {
+        pair<dataset_view, dataset_view> split = kfold_split(d, 4, f);
+        model alone(split.first);
+        train_report r = alone.train(settings);
+        assert(cv.folds[f].train.cost == r.cost && cv.folds[f].train.epochs == r.epochs);
+        assert(cv.folds[f].testCost == alone.calcJ(split.second));
+        sum += cv.folds[f].testCost;
+    }
+    assert(close_to(cv.meanCost, sum / 4) && cv.stddevCost >= 0);
+
+    // a diverging step is cancelled; the best step wins and is never cut
+    model_settings base;
+    base.algo = "gradient";
+    vector<model_settings> grid = parameter_grid(base, {0.001, 0.5, 0.1, 1000}, {200});
+    assert(grid.size() == 4 && grid[1].step == 0.5 && grid[3].epochs == 200);
+    search_report report = grid_search(d, grid, search);
+    assert(report.best == 1 && !report.candidates[1].cancelled);
+    assert(report.candidates[1].meanCost == cv.meanCost);
+    assert(report.candidates[3].cancelled && isnan(report.candidates[3].meanCost));
+    assert(report.cancelled >= 1 && report.seconds > 0);
+
+    // without pruning every candidate finishes
+    search_settings unpruned;
+    unpruned.folds = 4;
+    unpruned.threads = 2;
+    unpruned.prune = 0;
+    report = grid_search(d, {grid[0], grid[1]}, unpruned);
+    assert(report.cancelled == 0 && report.best == 1);
+    assert(report.candidates[0].meanCost > report.candidates[1].meanCost);
+
+    filesystem::remove(path);
+    cout << "✓ Grid search test passed" << endl;
+}
+
+void test_categorical_features()
+{
+    // y = 2a + effect(g) + 0.5, g missing on some rows (no effect)
+    string path = (filesystem::temp_directory_path() / "hs_test_category.csv").string();
+    {
+        const char *levels[] = {"B", "A", "C"};
+        const double effects[] = {-2, 1, 4};
+        ofstream out(path);
+        out << "a,g,y\n";
+        for (int i = 0; i < 3000; i++)
+        {
+            double a = (i % 17) / 17.0;
+            bool missing = i % 29 == 0;
+            out << a << "," << (missing ? "" : levels[i % 3]) << "," << 2 * a + (missing ? 0 : effects[i % 3]) + 0.5
+                << "\n";
+        }
+    }
+    load_settings load;
+    load.infer = true;
+    dataset d(path, load);
+    d.chooseX({"a", "g"}).chooseY("y");
+
+    // one weight per level (A, C, B by first appearance), after the inputs;
+    // the category's own slot stays 0
+    model m(d);
+    model_settings settings;
+    settings.epochs = 3000;
+    settings.step = 0.5;
+    m.train(settings);
+    assert((m.getNames() == vector<string>{"g", "a", "g=A", "g=C", "g=B"}));
+    assert(m.getW().size() == 5 && m.getW()[0] == 0.0);
+    assert(m.getJ() < 1e-6);
+    assert(fabs(m.predict({1.0, 0.5}) - 5.5) < 1e-2 && fabs(m.predict({-1.0, 0.5}) - 1.5) < 1e-2);
+
+    vector<double> out(d.rows());
+    m.predict(d, out.data(), out.size());
+    for (int i = 0; i < d.rows(); i += 13)
+        assert(close_to(out[i], m.predict(d.getRow(i))));
+
+    // another file's dictionary is matched by name; unseen levels add nothing
+    string other = (filesystem::temp_directory_path() / "hs_test_category_other.csv").string();
+    ofstream(other) << "a,g,y\n0.5,C,0\n0.5,D,0\n0.5,,0\n0.5,B,0\n";
+    dataset fresh(other, load);
+    fresh.chooseX({"a", "g"}).chooseY("y");
+    vector<double> scored(4);
+    m.predict(fresh, scored.data(), scored.size());
+    assert(close_to(scored[0], m.predict({1.0, 0.5})) && close_to(scored[1], m.predict({-1.0, 0.5})));
+    assert(close_to(scored[2], scored[1]) && close_to(scored[3], m.predict({2.0, 0.5})));
+
+    // target encoding: a single weight on each level's smoothed mean target
+    // (a feature on the scale of y, hence the smaller step)
+    model t(d);
+    model_settings tSettings;
+    tSettings.epochs = 3000;
+    tSettings.step = 0.05;
+    tSettings.encoding = "target";
+    t.train(tSettings);
+    assert(t.getW().size() == 2 && t.getNames().size() == 2);
+    d.settings.x = {};
+    d.chooseX({"a"});
+    model numeric(d);
+    numeric.train(settings);
+    assert(fabs(t.getW()[0] - 1.0) < 0.05 && t.getJ() < 0.05 && t.getJ() < numeric.getJ() / 10);
+
+    // paths that only know plain numbers refuse a categorical model
+    model_settings normal, hashed;
+    normal.algo = "normal";
+    hashed.encoding = "hashed";
+    for (const function<void()> &call : vector<function<void()>>{
+             [&] { m.train(normal); },
+             [&] { m.export_binary("hs_test_category.hsm"); },
+             [&] { m.train(hashed); }})
+    {
+        bool threw = false;
+        try
+        {
+            call();
+        }
+        catch (const runtime_error &)
+        {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    filesystem::remove(path);
+    filesystem::remove(other);
+    cout << "✓ Categorical features test passed" << endl;
+}
+
+int main()
+{
+    cout << "Running HomemadeScikit model tests...\n"
+         << endl;
+
+    test_streaming_matches_in_memory();
+    test_async_source();
+    test_threaded_training();
+    test_stochastic_training();
+    test_closed_form();
+    test_batch_prediction();
+    test_simd_kernels();
+    test_float_precision();
+    test_fixed_model();
+    test_vector_expressions();
+    test_telemetry();
+    test_early_stopping();
+    test_feature_scaling();
+    test_model_files();
+    test_partial_fit();
+    test_view_training();
+    test_grid_search();
+    test_categorical_features();
+
+    cout << "\nAll tests completed!" << endl;
+    return 0;
+}